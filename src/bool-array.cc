@@ -34,6 +34,8 @@ Bool_Array::~Bool_Array ()
              "size = %d\niteration number = %d\nend of array dump\n",
              _size, _iteration_number);
   delete[] const_cast<unsigned int *>(_storage_array);
+  delete[] const_cast<unsigned long *>(_bit_words);
+  delete[] const_cast<unsigned int *>(_dirty_words);
 }
 
 #ifndef __OPTIMIZE__
@@ -31,7 +31,21 @@
      - clear will be called 3509 times,
      - set_bit will be called 300394 times.
    With a conventional bit array implementation, clear would be too slow.
-   With a tree/hash based bit array implementation, set_bit would be slower. */
+   With a tree/hash based bit array implementation, set_bit would be slower.
+
+   For large sizes (many keywords, or a large -s factor), an iteration number
+   per bit no longer fits into the CPU caches.  Therefore, from
+   BOOL_ARRAY_COMPACT_MIN bits on, a real bit array is used instead, together
+   with a list of the words that are nonzero, so that clear only needs to
+   touch the words that were set since the last clear.  */
+
+/* Smallest size for which the compact representation is used.  */
+#ifndef BOOL_ARRAY_COMPACT_MIN
+#define BOOL_ARRAY_COMPACT_MIN 65536
+#endif
+
+/* Number of bits in a word of the compact representation.  */
+#define BOOL_ARRAY_WORD_BITS (8 * sizeof (unsigned long))
 
 class Bool_Array
 {
@@ -54,13 +68,26 @@ private:
   /* Size of array.  */
   unsigned int const    _size;
 
+  /* Number of words in _bit_words, or 0 if not in compact mode.  */
+  unsigned int const    _word_count;
+
   /* Current iteration number.  Always nonzero.  Starts out as 1, and is
      incremented each time clear() is called.  */
   unsigned int          _iteration_number;
 
   /* For each index, we store in storage_array[index] the iteration_number at
-     the time set_bit(index) was last called.  */
+     the time set_bit(index) was last called.  NULL in compact mode.  */
   unsigned int * const  _storage_array;
+
+  /* In compact mode: the bits, packed into words.  */
+  unsigned long * const _bit_words;
+
+  /* In compact mode: the indices of the words in _bit_words that have become
+     nonzero since the last clear() call.  */
+  unsigned int * const  _dirty_words;
+
+  /* Number of elements in _dirty_words.  */
+  unsigned int          _dirty_count;
 };
 
 #ifdef __OPTIMIZE__  /* efficiency hack! */
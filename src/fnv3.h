@@ -1,8 +1,9 @@
 #include <stdint.h>
 
-/* MPH needs at least 96 bit */
+/* MPH needs at least 96 bit: the low and high half of the first hash
+   and the low half of the second.  */
 static inline void fnv3(const void *key, size_t len, uint64_t seed,
-			uint64_t *hashes)
+			uint32_t *hashes)
 {
   uint64_t  h0 = seed ^ UINT64_C(0xcbf29ce484222325);
   uint64_t  h1 = seed ^ UINT64_C(0xc4ceb9fe1a85ec53); /* from PMP_Multilinear */
@@ -16,6 +17,31 @@ static inline void fnv3(const void *key, size_t len, uint64_t seed,
     h1 *= UINT64_C(0x100000001b3);
     data++;
   }
-  hashes[0] = h0;
-  hashes[1] = h1;
+  hashes[0] = (uint32_t)h0;
+  hashes[1] = (uint32_t)(h0 >> 32);
+  hashes[2] = (uint32_t)h1;
+}
+
+/* fnv3 of the key with the ASCII upper case letters folded to lower case,
+   for --ignore-case.  */
+static inline void fnv3_lower(const void *key, size_t len, uint64_t seed,
+			      uint32_t *hashes)
+{
+  uint64_t  h0 = seed ^ UINT64_C(0xcbf29ce484222325);
+  uint64_t  h1 = seed ^ UINT64_C(0xc4ceb9fe1a85ec53);
+  uint8_t  *data = (uint8_t *)key;
+  const uint8_t *const end = &data[len];
+
+  while (data < end) {
+    uint8_t c = *data++;
+    if (c >= 'A' && c <= 'Z')
+      c += 'a' - 'A';
+    h0 ^= c;
+    h0 *= UINT64_C(0x100000001b3);
+    h1 ^= c;
+    h1 *= UINT64_C(0x100000001b3);
+  }
+  hashes[0] = (uint32_t)h0;
+  hashes[1] = (uint32_t)(h0 >> 32);
+  hashes[2] = (uint32_t)h1;
 }
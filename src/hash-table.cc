@@ -1,4 +1,4 @@
-/* Hash table for checking keyword links.  Implemented using double hashing.
+/* Hash table for checking keyword links.  Implemented using linear probing.
    Copyright (C) 1989-1998, 2000, 2002-2003 Free Software Foundation, Inc.
    Written by Douglas C. Schmidt <schmidt@ics.uci.edu>
    and Bruno Haible <bruno@clisp.org>.
@@ -23,23 +23,25 @@
 
 #include <stdio.h>
 #include <string.h> /* declares memset(), strcmp() */
-#include <hash.h>
 #include "options.h"
 
-/* We use a hash table with double hashing.  This is the simplest kind of
-   hash table, given that we always only insert and never remove entries
-   from the hash table.  */
+/* We use an open addressing hash table with linear probing.  This is the
+   simplest kind of hash table, given that we always only insert and never
+   remove entries from the hash table.  Each entry holds a 64-bit
+   fingerprint of the item, so that a probe of a non-matching entry costs
+   no access to the KeywordExt and its _selchars.  */
 
-/* To make double hashing efficient, there need to be enough spare entries.  */
-static const int size_factor = 10;
+/* To make linear probing efficient, there need to be enough spare
+   entries.  */
+static const int size_factor = 2;
 
-/* We make the size of the hash table a power of 2.  This allows for two
-   optimizations: It eliminates the modulo instruction, and allows for an
-   easy secondary hashing function.  */
+/* We make the size of the hash table a power of 2.  This eliminates the
+   modulo instruction.  */
 
 /* Constructor.  */
 Hash_Table::Hash_Table (unsigned int size, bool ignore_length)
   : _ignore_length (ignore_length),
+    _iteration_number (1),
     _collisions (0)
 {
   /* There need to be enough spare entries.  */
@@ -47,36 +49,13 @@ Hash_Table::Hash_Table (unsigned int size, bool ignore_length)
 
   /* Find smallest power of 2 that is >= size.  */
   unsigned int shift = 0;
-  if ((size >> 16) > 0)
-    {
-      size = size >> 16;
-      shift += 16;
-    }
-  if ((size >> 8) > 0)
-    {
-      size = size >> 8;
-      shift += 8;
-    }
-  if ((size >> 4) > 0)
-    {
-      size = size >> 4;
-      shift += 4;
-    }
-  if ((size >> 2) > 0)
-    {
-      size = size >> 2;
-      shift += 2;
-    }
-  if ((size >> 1) > 0)
-    {
-      size = size >> 1;
-      shift += 1;
-    }
+  while ((1U << shift) < size)
+    shift++;
   _log_size = shift;
   _size = 1 << shift;
 
   /* Allocate table.  */
-  _table = new KeywordExt*[_size];
+  _table = new Entry[_size];
   memset (_table, 0, _size * sizeof (*_table));
 }
 
@@ -86,6 +65,18 @@ Hash_Table::~Hash_Table ()
   delete[] _table;
 }
 
+/* Removes all entries.  */
+void
+Hash_Table::clear ()
+{
+  /* If we wrap around it's time to zero things out again.  */
+  if (++_iteration_number == 0)
+    {
+      _iteration_number = 1;
+      memset (_table, 0, _size * sizeof (*_table));
+    }
+}
+
 /* Print the table's contents.  */
 void
 Hash_Table::dump () const
@@ -95,9 +86,9 @@ Hash_Table::dump () const
   field_width = 0;
   {
     for (int i = _size - 1; i >= 0; i--)
-      if (_table[i])
-        if (field_width < _table[i]->_selchars_length)
-          field_width = _table[i]->_selchars_length;
+      if (_table[i]._iteration == _iteration_number)
+        if (field_width < _table[i]._item->_selchars_length)
+          field_width = _table[i]._item->_selchars_length;
   }
 
   fprintf (stderr,
@@ -108,20 +99,38 @@ Hash_Table::dump () const
            _collisions, field_width, "keysig");
 
   for (int i = _size - 1; i >= 0; i--)
-    if (_table[i])
+    if (_table[i]._iteration == _iteration_number)
       {
+        KeywordExt *item = _table[i]._item;
         fprintf (stderr, "%8d, ", i);
-        if (field_width > _table[i]->_selchars_length)
-          fprintf (stderr, "%*s", field_width - _table[i]->_selchars_length, "");
-        for (int j = 0; j < _table[i]->_selchars_length; j++)
-          putc (_table[i]->_selchars[j], stderr);
+        if (field_width > item->_selchars_length)
+          fprintf (stderr, "%*s", field_width - item->_selchars_length, "");
+        for (int j = 0; j < item->_selchars_length; j++)
+          putc (item->_selchars[j], stderr);
         fprintf (stderr, ", %.*s\n",
-                 _table[i]->_allchars_length, _table[i]->_allchars);
+                 item->_allchars_length, item->_allchars);
       }
 
   fprintf (stderr, "\nend dumping hash table\n\n");
 }
 
+/* Computes the fingerprint of an item.  */
+inline uint64_t
+Hash_Table::fingerprint (KeywordExt *item) const
+{
+  uint64_t h = item->_selchars_length;
+  if (!_ignore_length)
+    h += static_cast<uint64_t>(item->_allchars_length) << 32;
+  for (int i = 0; i < item->_selchars_length; i++)
+    {
+      h = (h ^ item->_selchars[i]) * 0x9E3779B97F4A7C15ULL;
+      h ^= h >> 29;
+    }
+  h *= 0xBF58476D1CE4E5B9ULL;
+  h ^= h >> 32;
+  return h;
+}
+
 /* Compares two items.  */
 inline bool
 Hash_Table::equal (KeywordExt *item1, KeywordExt *item2) const
@@ -139,27 +148,22 @@ Hash_Table::equal (KeywordExt *item1, KeywordExt *item2) const
 KeywordExt *
 Hash_Table::insert (KeywordExt *item)
 {
-  unsigned hash_val =
-    hashpjw (reinterpret_cast<const unsigned char *>(item->_selchars),
-             item->_selchars_length * sizeof (unsigned int));
-  unsigned int probe = hash_val & (_size - 1);
-  unsigned int increment =
-    (((hash_val >> _log_size)
-      ^ (_ignore_length ? 0 : item->_allchars_length))
-     << 1) + 1;
-  /* Note that because _size is a power of 2 and increment is odd,
-     we have gcd(increment,_size) = 1, which guarantees that we'll find
-     an empty entry during the loop.  */
-
-  while (_table[probe] != NULL)
+  uint64_t fp = fingerprint (item);
+  unsigned int probe =
+    static_cast<unsigned int>((fp * 0x9E3779B97F4A7C15ULL) >> (64 - _log_size));
+
+  while (_table[probe]._iteration == _iteration_number)
     {
-      if (equal (_table[probe], item))
-        return _table[probe];
+      if (_table[probe]._fingerprint == fp
+          && equal (_table[probe]._item, item))
+        return _table[probe]._item;
 
       _collisions++;
-      probe = (probe + increment) & (_size - 1);
+      probe = (probe + 1) & (_size - 1);
     }
 
-  _table[probe] = item;
+  _table[probe]._fingerprint = fp;
+  _table[probe]._item = item;
+  _table[probe]._iteration = _iteration_number;
   return NULL;
 }
@@ -24,6 +24,7 @@
 #ifndef hash_table_h
 #define hash_table_h 1
 
+#include <stdint.h>
 #include "keyword.h"
 
 /* Hash table of KeywordExt* entries.
@@ -39,6 +40,9 @@ public:
                         Hash_Table (unsigned int size, bool ignore_length);
   /* Destructor.  */
                         ~Hash_Table ();
+  /* Removes all entries.  Takes constant time, so that the same table can
+     be used for many rounds of duplicate detection.  */
+  void                  clear ();
   /* Attempts to insert ITEM in the table.  If there is already an equal
      entry in it, returns it.  Otherwise inserts ITEM and returns NULL.  */
   KeywordExt *          insert (KeywordExt *item);
@@ -46,17 +50,34 @@ public:
   void                  dump () const;
 
 private:
+  /* An entry of the table.  The fingerprint of the item's _selchars is
+     stored next to the item, so that probing rarely needs to look at the
+     item itself.  */
+  struct Entry
+  {
+    uint64_t            _fingerprint;
+    KeywordExt *        _item;
+    /* The value of _iteration_number when the entry was filled.  The entry
+       is empty if this differs from _iteration_number.  */
+    unsigned int        _iteration;
+  };
+
   /* Vector of entries.  */
-  KeywordExt **         _table;
+  Entry *               _table;
   /* Size of the vector.  */
   unsigned int          _size;
   /* log2(_size).  */
   unsigned int          _log_size;
   /* A detail of the comparison function.  */
   bool const            _ignore_length;
+  /* Current iteration number.  Always nonzero.  Starts out as 1, and is
+     incremented each time clear() is called.  */
+  unsigned int          _iteration_number;
   /* Statistics: Number of collisions so far.  */
   unsigned int          _collisions;
 
+  /* Computes the fingerprint of an item.  */
+  uint64_t              fingerprint (KeywordExt *item) const;
   /* Compares two items.  */
   bool                  equal (KeywordExt *item1, KeywordExt *item2) const;
 };
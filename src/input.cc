@@ -569,6 +569,41 @@ Input::read_input ()
                   option.set (SHAREDLIB);
                 else
 
+                if (is_declaration (line, line_end, lineno,
+                                    "merged-string-pool"))
+                  {
+                    option.set (SHAREDLIB);
+                    option.set (MERGEDPOOL);
+                  }
+                else
+
+                if (is_declaration (line, line_end, lineno, "split-table"))
+                  option.set (SPLITTABLE);
+                else
+
+                if (is_declaration (line, line_end, lineno, "aligned-tables"))
+                  option.set (ALIGNEDTABLES);
+                else
+
+                if (is_declaration (line, line_end, lineno, "packed-tables"))
+                  option.set (PACKEDTABLES);
+                else
+
+                if (is_declaration_with_arg (line, line_end, lineno,
+                                             "fingerprints", &arg))
+                  {
+                    int fingerprint_bits = atoi (arg);
+                    if (fingerprint_bits != 8 && fingerprint_bits != 16)
+                      {
+                        fprintf (stderr, "%s:%u: fingerprint width %s"
+                                 " must be 8 or 16\n",
+                                 pretty_input_file_name (), lineno, arg);
+                        exit (1);
+                      }
+                    option.set_fingerprint_bits (fingerprint_bits);
+                  }
+                else
+
                 if (is_define_declaration (line, line_end, lineno,
                                            "string-pool-name", &arg))
                   option.set_stringpool_name (arg);
@@ -77,6 +77,8 @@ struct KeywordExt : public Keyword
 
   /* Data members used by the output routines.  */
   unsigned int          _final_index;
+  /* Offset of the keyword's string in the merged string pool.  */
+  int                   _stringpool_offset;
 
 private:
   unsigned int *        init_selchars_low (const Positions& positions, const unsigned int *alpha_unify, const unsigned int *alpha_inc);
@@ -27,6 +27,7 @@
 #include "output.h"
 #include "output-javascript.h"
 #include "output-lua.h"
+#include "output-cxx.h"
 
 #ifdef PERF
 #include "../tests/perf.h"
@@ -85,7 +86,31 @@ main (int argc, char *argv[])
       Search searcher (list);
       /* Output the hash function code.  */
 	  Output *outputter;
-        if (option[JAVASCRIPT])
+        if (option[CONSTEXPR])
+          {
+            outputter = new OutputCxx(searcher._head,
+                                 inputter._struct_decl,
+                                 inputter._struct_decl_lineno,
+                                 inputter._return_type,
+                                 inputter._struct_tag,
+                                 inputter._verbatim_declarations,
+                                 inputter._verbatim_declarations_end,
+                                 inputter._verbatim_declarations_lineno,
+                                 inputter._verbatim_code,
+                                 inputter._verbatim_code_end,
+                                 inputter._verbatim_code_lineno,
+                                 inputter._charset_dependent,
+                                 searcher._total_keys,
+                                 searcher._max_key_len,
+                                 searcher._min_key_len,
+                                 searcher._hash_includes_len,
+                                 searcher._key_positions,
+                                 searcher._alpha_inc,
+                                 searcher._total_duplicates,
+                                 searcher._alpha_size,
+                                 searcher._asso_values);
+          }
+        else if (option[JAVASCRIPT])
           {
             outputter = new OutputJavascript(searcher._head,
                                         inputter._struct_decl,
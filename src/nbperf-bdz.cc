@@ -37,6 +37,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "options.h"
 #include "output.h"
 #include "nbperf.h"
 
@@ -128,83 +129,465 @@ assign_nodes(struct bdzstate *state)
 	}
 }
 
+/*
+ * Returns bit PLANE of the g values of the vertices 64 * W ... 64 * W + 63.
+ */
+static uint64_t
+plane_word(const struct bdzstate *state, size_t w, int plane)
+{
+	uint64_t sum = 0;
+	size_t i;
+
+	for (i = w * 64; i < state->graph.v && i < w * 64 + 64; ++i)
+		sum |= (((uint64_t)state->g[i] >> plane) & 1) << (i & 63);
+	return sum;
+}
+
+/*
+ * Fills BLOCK with the rank block of the vertices 64 * B ... 64 * B + 63,
+ * which holds everything a lookup reads for one vertex: the two bit planes
+ * of the vertices, the number of holes before the block, and an unused
+ * word, so that a block is 32 bytes and never straddles a cache line.
+ */
+static void
+rank_block(const struct bdzstate *state, size_t b, uint64_t block[4])
+{
+	size_t i = b * 64;
+
+	block[0] = plane_word(state, b, 0);
+	block[1] = plane_word(state, b, 1);
+	block[2] = state->holes64k[i >> 16] + state->holes64[i >> 6];
+	block[3] = 0;
+}
+
+/*
+ * Emits the table entry WORD with DIGITS hex digits, as the N-th entry
+ * of lines of PER_LINE entries.
+ */
+static void
+print_word(Output_Buffer& body, uint64_t word, int digits, size_t n,
+    size_t per_line)
+{
+	body.put (n % per_line == 0 ? "\t    0x" : " 0x");
+	body.put_hex (word, digits);
+	body.put (n % per_line == per_line - 1 ? ",\n" : ",");
+}
+
+/*
+ * A table for the print_*_entries() functions, which format the entries
+ * START ... END-1 of it into BODY.  They are called by
+ * Output_Buffer::put_table(), possibly on a worker thread.
+ */
+struct bdztable {
+	const struct bdzstate *state;
+	int plane;
+};
+
+static void
+print_plane_entries(Output_Buffer& body, size_t start, size_t end,
+    const void *data)
+{
+	const struct bdztable *table = (const struct bdztable *)data;
+	size_t w;
+
+	for (w = start; w < end; ++w)
+		print_word(body, plane_word(table->state, w, table->plane), 16,
+		    w, 2);
+}
+
+static void
+print_holes64_entries(Output_Buffer& body, size_t start, size_t end,
+    const void *data)
+{
+	const struct bdztable *table = (const struct bdztable *)data;
+	size_t w;
+
+	for (w = start; w < end; ++w)
+		print_word(body, table->state->holes64[w], 4, w, 4);
+}
+
+static void
+print_block_entries(Output_Buffer& body, size_t start, size_t end,
+    const void *data)
+{
+	const struct bdztable *table = (const struct bdztable *)data;
+	uint64_t block[4];
+	size_t b;
+
+	for (b = start; b < end; ++b) {
+		rank_block(table->state, b, block);
+		body.put ("\t    { 0x");
+		body.put_hex (block[0], 16);
+		body.put (", 0x");
+		body.put_hex (block[1], 16);
+		body.put (", ");
+		body.put_decimal (block[2], 0);
+		body.put (", 0 },\n");
+	}
+}
+
+/*
+ * Emits the tables of the lookup as rank blocks of rank_block(), instead
+ * of the separate g1[], g2[], holes64[] and holes64k[] tables.  The
+ * authoritive vertex is one of the three probed vertices, so the rank
+ * step reads a cache line which is already loaded.
+ */
+static void
+print_hash_blocks(struct nbperf *nbperf, struct bdzstate *state)
+{
+	struct bdztable table;
+	Output *out = nbperf->out;
+
+	out->add_hash_body (
+	    "\tstatic const uint64_t blocks[%" PRId32 "][4] GPERF_ALIGNED = {\n",
+	    (state->graph.v + 63) / 64);
+	table.state = state;
+	table.plane = 0;
+	out->hash_body ().put_table ((state->graph.v + 63) / 64,
+	    print_block_entries, &table, option.get_threads ());
+	out->add_hash_body ("\t};\n");
+
+	out->add_hash_body ("\tuint32_t idx, idx2;\n");
+	out->add_hash_body ("\tuint32_t h[%zu];\n\n", nbperf->hash_size);
+}
+
+/*
+ * Adds the tables of the lookup to the binary tables file, instead of
+ * emitting them, and emits pointers to them.  The rank blocks of
+ * option[ALIGNEDTABLES] start at a cache line boundary of the file.
+ */
+static void
+print_binary_tables(struct nbperf *nbperf, struct bdzstate *state)
+{
+	size_t words = (state->graph.v + 63) / 64;
+	size_t w;
+	uint64_t *table;
+	int plane;
+	Output *out = nbperf->out;
+
+	if (option[ALIGNEDTABLES]) {
+		table = (uint64_t*) calloc(sizeof(uint64_t), 4 * words);
+		if (table == NULL)
+			err(1, "malloc failed");
+		for (w = 0; w < words; ++w)
+			rank_block(state, w, table + 4 * w);
+		out->add_binary_table ("uint64_t", "blocks", table, 4 * words,
+		    sizeof(uint64_t));
+		out->add_hash_body ("	const uint64_t (*blocks)[4] =\n"
+		    "	    (const uint64_t (*)[4])gperf_tables.blocks;\n");
+	} else {
+		table = (uint64_t*) calloc(sizeof(uint64_t), words);
+		if (table == NULL)
+			err(1, "malloc failed");
+		for (plane = 0; plane < 2; ++plane) {
+			for (w = 0; w < words; ++w)
+				table[w] = plane_word(state, w, plane);
+			out->add_binary_table ("uint64_t", plane ? "g2" : "g1",
+			    table, words, sizeof(uint64_t));
+		}
+		out->add_binary_table ("uint32_t", "holes64k", state->holes64k,
+		    (state->graph.v + 65535) / 65536, sizeof(uint32_t));
+		out->add_binary_table ("uint16_t", "holes64", state->holes64,
+		    words, sizeof(uint16_t));
+		out->add_hash_body ("	const uint64_t *g1 = gperf_tables.g1;\n");
+		out->add_hash_body ("	const uint64_t *g2 = gperf_tables.g2;\n");
+		out->add_hash_body (
+		    "	const uint32_t *holes64k = gperf_tables.holes64k;\n");
+		out->add_hash_body (
+		    "	const uint16_t *holes64 = gperf_tables.holes64;\n");
+	}
+	free(table);
+
+	out->add_hash_body ("	uint32_t idx, idx2;\n");
+	out->add_hash_body ("	uint32_t h[%zu];\n\n", nbperf->hash_size);
+}
+
+/*
+ * Formats the entries START ... END-1 of the array of 32-bit words DATA
+ * for -L JavaScript.
+ */
+static void
+print_javascript_words(Output_Buffer& body, size_t start, size_t end,
+    const void *data)
+{
+	const uint32_t *words = (const uint32_t *)data;
+	size_t w;
+
+	for (w = start; w < end; ++w) {
+		body.put (w % 4 == 0 ? "    0x" : " 0x");
+		body.put_hex (words[w], 8);
+		body.put (w % 4 == 3 ? ",\n" : ",");
+	}
+}
+
+/*
+ * Emits the tables for -L JavaScript, at the top level of the module.
+ * JavaScript has only 32-bit integer operations, so the two bit planes
+ * are split into 32-bit words, and holes[] has the number of holes before
+ * each word.  popcount() counts the bits of a 32-bit word.
+ */
+static void
+print_javascript_tables(struct nbperf *nbperf, struct bdzstate *state)
+{
+	size_t words = (state->graph.v + 31) / 32;
+	size_t w, i;
+	uint32_t *table, holes;
+	int plane;
+	Output_Buffer& tables = nbperf->out->hash_tables ();
+
+	table = (uint32_t*) calloc(sizeof(uint32_t), words);
+	if (table == NULL)
+		err(1, "malloc failed");
+	for (plane = 0; plane < 2; ++plane) {
+		for (w = 0; w < words; ++w)
+			table[w] = (uint32_t)(plane_word(state, w / 2, plane)
+			    >> (32 * (w % 2)));
+		tables.printf ("  var g%d = new Uint32Array([\n", plane + 1);
+		tables.put_table (words, print_javascript_words, table,
+		    option.get_threads ());
+		tables.printf ("%s  ]);\n", words % 4 ? "\n" : "");
+	}
+	holes = 0;
+	for (i = 0; i < state->graph.v; ++i) {
+		if (i % 32 == 0)
+			table[i / 32] = holes;
+		if (state->g[i] == 3)
+			++holes;
+	}
+	tables.put ("  var holes = new Uint32Array([\n");
+	tables.put_table (words, print_javascript_words, table,
+	    option.get_threads ());
+	tables.printf ("%s  ]);\n", words % 4 ? "\n" : "");
+	free(table);
+
+	tables.printf ("  var h = new Uint32Array(%zu);\n\n", nbperf->hash_size);
+	tables.put ("  function popcount (x) {\n"
+	    "    x -= (x >>> 1) & 0x55555555;\n"
+	    "    x = (x & 0x33333333) + ((x >>> 2) & 0x33333333);\n"
+	    "    x = (x + (x >>> 4)) & 0x0f0f0f0f;\n"
+	    "    return Math.imul(x, 0x01010101) >>> 24;\n"
+	    "  }\n\n");
+
+	nbperf->out->add_hash_body ("\tvar idx;\n\n");
+}
+
+/*
+ * Emits the tables for --constexpr, as static constexpr members of the
+ * class, together with a constexpr popcount64(), since
+ * __builtin_popcountll is not portable and std::popcount needs C++20.
+ */
+static void
+print_constexpr_tables(struct nbperf *nbperf, struct bdzstate *state)
+{
+	struct bdztable table;
+	size_t i;
+	Output_Buffer& tables = nbperf->out->hash_tables ();
+
+	table.state = state;
+	for (table.plane = 0; table.plane < 2; ++table.plane) {
+		tables.printf ("  static constexpr uint64_t g%d[] =\n"
+		    "    {\n", table.plane + 1);
+		tables.put_table ((state->graph.v + 63) / 64,
+		    print_plane_entries, &table, option.get_threads ());
+		tables.printf ("%s    };\n",
+		    ((state->graph.v + 63) / 64 % 2 ? "\n" : ""));
+	}
+
+	tables.put ("  static constexpr uint32_t holes64k[] =\n"
+	    "    {\n");
+	for (i = 0; i < state->graph.v; i += 65536)
+		print_word(tables, state->holes64k[i >> 16], 8, i / 65536, 4);
+	tables.printf ("%s    };\n", (i / 65536 % 4 ? "\n" : ""));
+
+	tables.put ("  static constexpr uint16_t holes64[] =\n"
+	    "    {\n");
+	tables.put_table ((state->graph.v + 63) / 64, print_holes64_entries,
+	    &table, option.get_threads ());
+	tables.printf ("%s    };\n",
+	    ((state->graph.v + 63) / 64 % 4 ? "\n" : ""));
+
+	tables.put ("  static constexpr unsigned int popcount64 (uint64_t x)\n"
+	    "  {\n"
+	    "    x -= (x >> 1) & UINT64_C(0x5555555555555555);\n"
+	    "    x = (x & UINT64_C(0x3333333333333333))\n"
+	    "        + ((x >> 2) & UINT64_C(0x3333333333333333));\n"
+	    "    x = (x + (x >> 4)) & UINT64_C(0x0f0f0f0f0f0f0f0f);\n"
+	    "    return static_cast<unsigned int>((x * UINT64_C(0x0101010101010101)) >> 56);\n"
+	    "  }\n");
+}
+
+/*
+ * Formats the entries START ... END-1 of the array of 64-bit words DATA
+ * for -L Lua.
+ */
+static void
+print_lua_words(Output_Buffer& body, size_t start, size_t end,
+    const void *data)
+{
+	const uint64_t *words = (const uint64_t *)data;
+	size_t w;
+
+	for (w = start; w < end; ++w) {
+		body.put (w % 2 == 0 ? "    0x" : " 0x");
+		body.put_hex (words[w], 16);
+		body.put (w % 2 == 1 ? ",\n" : ",");
+	}
+}
+
+/*
+ * Emits the tables for -L Lua, at the top level of the chunk.  The Lua
+ * integers have 64 bits, so the bit planes keep their 64-bit words, and
+ * holes[] has the number of holes before each word.  popcount() counts
+ * the bits of a 64-bit word.  Then emits the lookup, after the hash
+ * function, which has stored the hash values into the locals h0, h1 and
+ * h2.
+ */
+static void
+print_lua(struct nbperf *nbperf, struct bdzstate *state)
+{
+	size_t words = (state->graph.v + 63) / 64;
+	size_t w, i;
+	uint64_t *table;
+	uint32_t holes;
+	int plane;
+	Output *out = nbperf->out;
+	Output_Buffer& tables = out->hash_tables ();
+
+	table = (uint64_t*) calloc(sizeof(uint64_t), words);
+	if (table == NULL)
+		err(1, "malloc failed");
+	for (plane = 0; plane < 2; ++plane) {
+		for (w = 0; w < words; ++w)
+			table[w] = plane_word(state, w, plane);
+		tables.printf ("local g%d = {\n", plane + 1);
+		tables.put_table (words, print_lua_words, table,
+		    option.get_threads ());
+		tables.printf ("%s}\n", words % 2 ? "\n" : "");
+	}
+	holes = 0;
+	for (i = 0; i < state->graph.v; ++i) {
+		if (i % 64 == 0)
+			table[i / 64] = holes;
+		if (state->g[i] == 3)
+			++holes;
+	}
+	tables.put ("local holes = {\n");
+	tables.put_table (words, print_lua_words, table,
+	    option.get_threads ());
+	tables.printf ("%s}\n\n", words % 2 ? "\n" : "");
+	free(table);
+
+	tables.put ("local function popcount(x)\n"
+	    "    x = x - ((x >> 1) & 0x5555555555555555)\n"
+	    "    x = (x & 0x3333333333333333) + ((x >> 2) & 0x3333333333333333)\n"
+	    "    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0f\n"
+	    "    return (x * 0x0101010101010101) >> 56\n"
+	    "end\n\n");
+
+	(*nbperf->print_hash)(nbperf, "\t", "str", "len", "h");
+
+	out->add_hash_body ("\n\th0 = h0 %% %" PRIu32 "\n", state->graph.v);
+	out->add_hash_body ("\th1 = h1 %% %" PRIu32 "\n", state->graph.v);
+	out->add_hash_body ("\th2 = h2 %% %" PRIu32 "\n", state->graph.v);
+
+	if (state->graph.hash_fudge & 1)
+		out->add_hash_body ("\tif h0 == h1 then h1 = h1 ~ 1 end\n");
+
+	if (state->graph.hash_fudge & 2) {
+		out->add_hash_body (
+		    "\tif h0 == h2 or h1 == h2 then h2 = h2 ~ 1 end\n");
+		out->add_hash_body (
+		    "\tif h0 == h2 or h1 == h2 then h2 = h2 ~ 2 end\n");
+	}
+
+	out->add_hash_body (
+	    "\tlocal idx = (9 + ((g1[(h0 >> 6) + 1] >> (h0 & 63)) & 1)\n"
+	    "\t               + ((g1[(h1 >> 6) + 1] >> (h1 & 63)) & 1)\n"
+	    "\t               + ((g1[(h2 >> 6) + 1] >> (h2 & 63)) & 1)\n"
+	    "\t               - ((g2[(h0 >> 6) + 1] >> (h0 & 63)) & 1)\n"
+	    "\t               - ((g2[(h1 >> 6) + 1] >> (h1 & 63)) & 1)\n"
+	    "\t               - ((g2[(h2 >> 6) + 1] >> (h2 & 63)) & 1)) %% 3\n"
+	    "\tif idx == 0 then\n"
+	    "\t    idx = h0\n"
+	    "\telseif idx == 1 then\n"
+	    "\t    idx = h1\n"
+	    "\telse\n"
+	    "\t    idx = h2\n"
+	    "\tend\n"
+	    "\tlocal w = (idx >> 6) + 1\n"
+	    "\treturn idx - holes[w]\n"
+	    "\t       - popcount(g1[w] & g2[w] & ((1 << (idx & 63)) - 1))\n");
+}
+
 static void
 print_hash(struct nbperf *nbperf, struct bdzstate *state)
 {
-	uint64_t sum;
+	struct bdztable table;
 	size_t i;
         Output *out = nbperf->out;
+	Output_Buffer& body = out->hash_body ();
+	/* With option[ALIGNEDTABLES] the vertex values and the holes are read
+	   from rank blocks, see rank_block().  */
+	const char *g1 = option[ALIGNEDTABLES] ? "blocks" : "g1";
+	const char *g2 = option[ALIGNEDTABLES] ? "blocks" : "g2";
+	const char *g1_end = option[ALIGNEDTABLES] ? "][0]" : "]";
+	const char *g2_end = option[ALIGNEDTABLES] ? "][1]" : "]";
+
+	if (option[LUA]) {
+		print_lua(nbperf, state);
+		return;
+	}
 
+	if (!option[JAVASCRIPT] && !option[CONSTEXPR]) {
         out->add_hash_body ("\n#ifdef __GNUC__\n"); // since gcc 4.5
         out->add_hash_body ("#define popcount64 __builtin_popcountll\n");
         out->add_hash_body ("#endif\n\n");
+	}
 
+	if (option[JAVASCRIPT]) {
+		print_javascript_tables(nbperf, state);
+	} else if (option[CONSTEXPR]) {
+		print_constexpr_tables(nbperf, state);
+	} else if (option[BINARYTABLES]) {
+		print_binary_tables(nbperf, state);
+	} else if (option[ALIGNEDTABLES]) {
+		print_hash_blocks(nbperf, state);
+	} else {
+	table.state = state;
 	out->add_hash_body (
 	    "\tstatic const uint64_t g1[%" PRId32 "] = {\n",
 	    (state->graph.v + 63) / 64);
-	sum = 0;
-	for (i = 0; i < state->graph.v; ++i) {
-		sum |= ((uint64_t)state->g[i] & 1) << (i & 63);
-		if (i % 64 == 63) {
-			out->add_hash_body ("%s0x%016" PRIx64 ",%s",
-			    (i / 64 % 2 == 0 ? "\t    " : " "),
-			    sum,
-			    (i / 64 % 2 == 1 ? "\n" : ""));
-			sum = 0;
-		}
-	}
-	if (i % 64 != 0) {
-		out->add_hash_body ("%s0x%016" PRIx64 ",%s",
-		    (i / 64 % 2 == 0 ? "\t    " : " "),
-		    sum,
-		    (i / 64 % 2 == 1 ? "\n" : ""));
-	}
-	out->add_hash_body ("%s\t};\n", (i % 2 ? "\n" : ""));
+	table.plane = 0;
+	body.put_table ((state->graph.v + 63) / 64, print_plane_entries, &table,
+	    option.get_threads ());
+	out->add_hash_body ("%s\t};\n", (state->graph.v % 2 ? "\n" : ""));
 
 	out->add_hash_body (
 	    "\tstatic const uint64_t g2[%" PRId32 "] = {\n",
 	    (state->graph.v + 63) / 64);
-	sum = 0;
-	for (i = 0; i < state->graph.v; ++i) {
-		sum |= (((uint64_t)state->g[i] & 2) >> 1) << (i & 63);
-		if (i % 64 == 63) {
-			out->add_hash_body ("%s0x%016" PRIx64 ",%s",
-			    (i / 64 % 2 == 0 ? "\t    " : " "),
-			    sum,
-			    (i / 64 % 2 == 1 ? "\n" : ""));
-			sum = 0;
-		}
-	}
-	if (i % 64 != 0) {
-		out->add_hash_body ("%s0x%016" PRIx64 ",%s",
-		    (i / 64 % 2 == 0 ? "\t    " : " "),
-		    sum,
-		    (i / 64 % 2 == 1 ? "\n" : ""));
-	}
-	out->add_hash_body ("%s\t};\n", (i % 2 ? "\n" : ""));
+	table.plane = 1;
+	body.put_table ((state->graph.v + 63) / 64, print_plane_entries, &table,
+	    option.get_threads ());
+	out->add_hash_body ("%s\t};\n", (state->graph.v % 2 ? "\n" : ""));
 
 	out->add_hash_body (
 	    "\tstatic const uint32_t holes64k[%" PRId32 "] = {\n",
 	    (state->graph.v + 65535) / 65536);
 	for (i = 0; i < state->graph.v; i += 65536)
-		out->add_hash_body ("%s0x%08" PRIx32 ",%s",
-		    (i / 65536 % 4 == 0 ? "\t    " : " "),
-		    state->holes64k[i >> 16],
-		    (i / 65536 % 4 == 3 ? "\n" : ""));
+		print_word(body, state->holes64k[i >> 16], 8, i / 65536, 4);
 	out->add_hash_body ("%s\t};\n", (i / 65536 % 4 ? "\n" : ""));
 
 	out->add_hash_body (
 	    "\tstatic const uint16_t holes64[%" PRId32 "] = {\n",
 	    (state->graph.v + 63) / 64);
-	for (i = 0; i < state->graph.v; i += 64)
-		out->add_hash_body ("%s0x%04" PRIx32 ",%s",
-		    (i / 64 % 4 == 0 ? "\t    " : " "),
-		    state->holes64[i >> 6],
-		    (i / 64 % 4 == 3 ? "\n" : ""));
-	out->add_hash_body ("%s\t};\n", (i / 64 % 4 ? "\n" : ""));
+	body.put_table ((state->graph.v + 63) / 64, print_holes64_entries,
+	    &table, option.get_threads ());
+	out->add_hash_body ("%s\t};\n",
+	    ((state->graph.v + 63) / 64 % 4 ? "\n" : ""));
 
 	out->add_hash_body ("\tuint32_t idx, idx2;\n");
 	out->add_hash_body ("\tuint32_t h[%zu];\n\n", nbperf->hash_size);
+	}
 
 	(*nbperf->print_hash)(nbperf, "\t", "str", "len", "h");
 
@@ -225,17 +608,57 @@ print_hash(struct nbperf *nbperf, struct bdzstate *state)
 		    "\th[2] ^= 2 * (h[0] == h[2] || h[1] == h[2]);\n");
 	}
 
+	if (option[JAVASCRIPT]) {
+		out->add_hash_body (
+		    "\tidx = 9 + ((g1[h[0] >>> 5] >>> (h[0] & 31)) & 1)\n"
+		    "\t        + ((g1[h[1] >>> 5] >>> (h[1] & 31)) & 1)\n"
+		    "\t        + ((g1[h[2] >>> 5] >>> (h[2] & 31)) & 1)\n"
+		    "\t        - ((g2[h[0] >>> 5] >>> (h[0] & 31)) & 1)\n"
+		    "\t        - ((g2[h[1] >>> 5] >>> (h[1] & 31)) & 1)\n"
+		    "\t        - ((g2[h[2] >>> 5] >>> (h[2] & 31)) & 1);\n"
+		    "\tidx = h[idx %% 3];\n"
+		    "\treturn idx - holes[idx >>> 5]\n"
+		    "\t       - popcount(g1[idx >>> 5] & g2[idx >>> 5]\n"
+		    "\t                  & ((1 << (idx & 31)) - 1));\n");
+		return;
+	}
+
+	if (option[CONSTEXPR]) {
+		out->add_hash_body (
+		    "\tuint32_t idx = 9 + ((g1[h[0] >> 6] >> (h[0] & 63)) & 1)\n"
+		    "\t                 + ((g1[h[1] >> 6] >> (h[1] & 63)) & 1)\n"
+		    "\t                 + ((g1[h[2] >> 6] >> (h[2] & 63)) & 1)\n"
+		    "\t                 - ((g2[h[0] >> 6] >> (h[0] & 63)) & 1)\n"
+		    "\t                 - ((g2[h[1] >> 6] >> (h[1] & 63)) & 1)\n"
+		    "\t                 - ((g2[h[2] >> 6] >> (h[2] & 63)) & 1);\n"
+		    "\tidx = h[idx %% 3];\n"
+		    "\treturn idx - holes64[idx >> 6] - holes64k[idx >> 16]\n"
+		    "\t       - popcount64(g1[idx >> 6] & g2[idx >> 6]\n"
+		    "\t                    & ((UINT64_C(1) << (idx & 63)) - 1));\n");
+		return;
+	}
+
 	out->add_hash_body (
-	    "\tidx = 9 + ((g1[h[0] >> 6] >> (h[0] & 63)) & 1)\n"
-	    "\t        + ((g1[h[1] >> 6] >> (h[1] & 63)) & 1)\n"
-	    "\t        + ((g1[h[2] >> 6] >> (h[2] & 63)) & 1)\n"
-	    "\t        - ((g2[h[0] >> 6] >> (h[0] & 63)) & 1)\n"
-	    "\t        - ((g2[h[1] >> 6] >> (h[1] & 63)) & 1)\n"
-	    "\t        - ((g2[h[2] >> 6] >> (h[2] & 63)) & 1);\n"
-	    );
+	    "\tidx = 9 + ((%s[h[0] >> 6%s >> (h[0] & 63)) & 1)\n"
+	    "\t        + ((%s[h[1] >> 6%s >> (h[1] & 63)) & 1)\n"
+	    "\t        + ((%s[h[2] >> 6%s >> (h[2] & 63)) & 1)\n"
+	    "\t        - ((%s[h[0] >> 6%s >> (h[0] & 63)) & 1)\n"
+	    "\t        - ((%s[h[1] >> 6%s >> (h[1] & 63)) & 1)\n"
+	    "\t        - ((%s[h[2] >> 6%s >> (h[2] & 63)) & 1);\n",
+	    g1, g1_end, g1, g1_end, g1, g1_end,
+	    g2, g2_end, g2, g2_end, g2, g2_end);
 
 	out->add_hash_body (
 	    "\tidx = h[idx %% 3];\n");
+	if (option[ALIGNEDTABLES]) {
+		out->add_hash_body (
+		    "\tidx2 = idx - (uint32_t)blocks[idx >> 6][2];\n"
+		    "\tidx2 -= popcount64(blocks[idx >> 6][0]\n"
+		    "\t                 & blocks[idx >> 6][1]\n"
+		    "\t                 & (((uint64_t)1 << (idx & 63)) - 1));\n"
+		    "\treturn idx2;\n");
+		return;
+	}
 	out->add_hash_body (
 	    "\tidx2 = idx - holes64[idx >> 6] - holes64k[idx >> 16];\n"
 	    "\tidx2 -= popcount64(g1[idx >> 6]\n"
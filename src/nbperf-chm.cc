@@ -139,14 +139,275 @@ assign_nodes(struct SIZED(state) *state)
 }
 #endif
 
+/*
+ * The g[] table as print_hex_entries() formats it: either 32-bit values
+ * or 64-bit words, with DIGITS hex digits and PER_LINE entries per line,
+ * each line starting with INDENT.
+ */
+struct hex_table {
+	const uint32_t *values32;
+	const uint64_t *values64;
+	int digits;
+	size_t per_line;
+	const char *indent;
+};
+
+/*
+ * Formats the entries START ... END-1 of the hex_table DATA into BODY.
+ * Called by Output_Buffer::put_table(), possibly on a worker thread.
+ */
+static void
+print_hex_entries(Output_Buffer& body, size_t start, size_t end,
+    const void *data)
+{
+	const struct hex_table *table = (const struct hex_table *)data;
+	size_t i;
+
+	for (i = start; i < end; ++i) {
+		if (i % table->per_line == 0)
+			body.put (table->indent);
+		body.put (i % table->per_line == 0 ? "0x" : " 0x");
+		body.put_hex (table->values64 != NULL
+		    ? table->values64[i] : table->values32[i], table->digits);
+		body.put (i % table->per_line == table->per_line - 1
+		    ? ",\n" : ",");
+	}
+}
+
+/*
+ * Emits g[] bit packed into an array of 64-bit words, with as many bits per
+ * entry as the largest value needs.  A trailing word lets the lookup read
+ * the two words an entry may straddle without checking whether it does.
+ * Returns the number of bits per entry.
+ */
+static int
+print_packed_g(struct nbperf *nbperf, struct SIZED(state) *state)
+{
+	uint32_t i, max;
+	uint64_t bit, *words;
+	size_t n;
+	int width;
+	struct hex_table table;
+        Output *out = nbperf->out;
+
+	max = 0;
+	for (i = 0; i < state->graph.v; ++i)
+		if (state->g[i] > max)
+			max = state->g[i];
+	for (width = 1; width < 32 && (max >> width) != 0; ++width)
+		;
+
+	n = ((uint64_t)state->graph.v * width + 63) / 64 + 1;
+	words = (uint64_t*) calloc(sizeof(uint64_t), n);
+	if (words == NULL)
+		err(1, "malloc failed");
+	for (i = 0; i < state->graph.v; ++i) {
+		bit = (uint64_t)i * width;
+		words[bit >> 6] |= (uint64_t)state->g[i] << (bit & 63);
+		if ((bit & 63) + width > 64)
+			words[(bit >> 6) + 1] |=
+			    (uint64_t)state->g[i] >> (64 - (bit & 63));
+	}
+
+	if (option[BINARYTABLES]) {
+		out->add_binary_table ("uint64_t", "g", words, n,
+		    sizeof(uint64_t));
+		out->add_hash_body ("\tconst uint64_t *g = gperf_tables.g;\n");
+	} else {
+	out->add_hash_body ("\tstatic const uint64_t g[%zu]%s = {\n", n,
+			       option[ALIGNEDTABLES] ? " GPERF_ALIGNED" : "");
+	table.values32 = NULL;
+	table.values64 = words;
+	table.digits = 16;
+	table.per_line = 2;
+	table.indent = "\t    ";
+	out->hash_body ().put_table (n, print_hex_entries, &table,
+	    option.get_threads ());
+	out->add_hash_body ("%s\t};\n", (n % 2 ? "\n" : ""));
+	}
+	free(words);
+
+	out->add_hash_body ("\tuint64_t bit;\n");
+	return width;
+}
+
+/*
+ * Adds g[] to the binary tables file as entries of SIZE bytes of type
+ * G_TYPE, instead of emitting it, and emits a pointer to it.
+ */
+static void
+print_binary_g(struct nbperf *nbperf, struct SIZED(state) *state,
+    const char *g_type, size_t size)
+{
+	uint32_t i;
+	uint8_t *g8;
+	uint16_t *g16;
+	Output *out = nbperf->out;
+
+	if (size == 1) {
+		g8 = (uint8_t*) malloc(state->graph.v);
+		if (g8 == NULL)
+			err(1, "malloc failed");
+		for (i = 0; i < state->graph.v; ++i)
+			g8[i] = state->g[i];
+		out->add_binary_table (g_type, "g", g8, state->graph.v, size);
+		free(g8);
+	} else if (size == 2) {
+		g16 = (uint16_t*) malloc(state->graph.v * sizeof(uint16_t));
+		if (g16 == NULL)
+			err(1, "malloc failed");
+		for (i = 0; i < state->graph.v; ++i)
+			g16[i] = state->g[i];
+		out->add_binary_table (g_type, "g", g16, state->graph.v, size);
+		free(g16);
+	} else {
+		out->add_binary_table (g_type, "g", state->g, state->graph.v,
+		    size);
+	}
+	out->add_hash_body ("\tconst %s *g = gperf_tables.g;\n", g_type);
+}
+
+/*
+ * Emits g[] for -L JavaScript, as a typed array at the top level of the
+ * module, together with the array h[] of the vertices.
+ */
+static void
+print_javascript_g(struct nbperf *nbperf, struct SIZED(state) *state)
+{
+	struct hex_table table;
+	Output_Buffer& tables = nbperf->out->hash_tables ();
+
+	if (state->graph.v >= 65536) {
+		tables.put ("  var g = new Uint32Array([\n");
+		table.digits = 8;
+		table.per_line = 4;
+	} else if (state->graph.v >= 256) {
+		tables.put ("  var g = new Uint16Array([\n");
+		table.digits = 4;
+		table.per_line = 8;
+	} else {
+		tables.put ("  var g = new Uint8Array([\n");
+		table.digits = 2;
+		table.per_line = 10;
+	}
+	table.values32 = state->g;
+	table.values64 = NULL;
+	table.indent = "    ";
+	tables.put_table (state->graph.v, print_hex_entries, &table,
+	    option.get_threads ());
+	tables.printf ("%s  ]);\n", state->graph.v % table.per_line ? "\n" : "");
+	tables.printf ("  var h = new Uint32Array(%zu);\n\n", nbperf->hash_size);
+}
+
+/*
+ * Emits g[] for --constexpr, as a static constexpr member of the class.
+ */
+static void
+print_constexpr_g(struct nbperf *nbperf, struct SIZED(state) *state)
+{
+	struct hex_table table;
+	Output_Buffer& tables = nbperf->out->hash_tables ();
+
+	if (state->graph.v >= 65536) {
+		tables.put ("  static constexpr uint32_t g[] =\n");
+		table.digits = 8;
+		table.per_line = 4;
+	} else if (state->graph.v >= 256) {
+		tables.put ("  static constexpr uint16_t g[] =\n");
+		table.digits = 4;
+		table.per_line = 8;
+	} else {
+		tables.put ("  static constexpr uint8_t g[] =\n");
+		table.digits = 2;
+		table.per_line = 10;
+	}
+	tables.put ("    {\n");
+	table.values32 = state->g;
+	table.values64 = NULL;
+	table.indent = "      ";
+	tables.put_table (state->graph.v, print_hex_entries, &table,
+	    option.get_threads ());
+	tables.printf ("%s    };\n", state->graph.v % table.per_line ? "\n" : "");
+}
+
+/*
+ * Emits g[] for -L Lua, as a table at the top level of the chunk.  Lua
+ * tables start at index 1.
+ */
+static void
+print_lua_g(struct nbperf *nbperf, struct SIZED(state) *state)
+{
+	struct hex_table table;
+	Output_Buffer& tables = nbperf->out->hash_tables ();
+
+	table.values32 = state->g;
+	table.values64 = NULL;
+	table.digits = state->graph.v >= 65536 ? 8 : state->graph.v >= 256 ? 4 : 2;
+	table.per_line = state->graph.v >= 65536 ? 4 : 8;
+	table.indent = "    ";
+	tables.put ("local g = {\n");
+	tables.put_table (state->graph.v, print_hex_entries, &table,
+	    option.get_threads ());
+	tables.printf ("%s}\n\n", state->graph.v % table.per_line ? "\n" : "");
+}
+
+/*
+ * Emits the Lua code of the lookup, after the hash function, which has
+ * stored the hash values into the locals h0, h1 and h2.
+ */
+static void
+print_lua_lookup(struct nbperf *nbperf, struct SIZED(state) *state)
+{
+	Output *out = nbperf->out;
+
+	out->add_hash_body ("\n\th0 = h0 %% %" PRIu32 "\n", state->graph.v);
+	out->add_hash_body ("\th1 = h1 %% %" PRIu32 "\n", state->graph.v);
+#if GRAPH_SIZE >= 3
+	out->add_hash_body ("\th2 = h2 %% %" PRIu32 "\n", state->graph.v);
+#endif
+
+	if (state->graph.hash_fudge & 1)
+		out->add_hash_body ("\tif h0 == h1 then h1 = h1 ~ 1 end\n");
+
+#if GRAPH_SIZE >= 3
+	if (state->graph.hash_fudge & 2) {
+		out->add_hash_body (
+		    "\tif h0 == h2 or h1 == h2 then h2 = h2 ~ 1 end\n");
+		out->add_hash_body (
+		    "\tif h0 == h2 or h1 == h2 then h2 = h2 ~ 2 end\n");
+	}
+	out->add_hash_body ("\treturn (g[h0 + 1] + g[h1 + 1] + g[h2 + 1]) %% "
+	    "%" PRIu32 "\n", state->graph.e);
+#else
+	out->add_hash_body ("\treturn (g[h0 + 1] + g[h1 + 1]) %% "
+	    "%" PRIu32 "\n", state->graph.e);
+#endif
+}
+
 static void
 print_hash(struct nbperf *nbperf, struct SIZED(state) *state)
 {
 	uint32_t i, per_line;
 	const char *g_type;
-	int g_width;
+	int g_width, bits = 0;
+	struct hex_table table;
         Output *out = nbperf->out;
 
+	if (option[LUA]) {
+		print_lua_g(nbperf, state);
+		(*nbperf->print_hash)(nbperf, "\t", "str", "len", "h");
+		print_lua_lookup(nbperf, state);
+		assert(nbperf->n == state->graph.e);
+		return;
+	}
+
+	if (option[JAVASCRIPT]) {
+		print_javascript_g(nbperf, state);
+	} else if (option[CONSTEXPR]) {
+		print_constexpr_g(nbperf, state);
+	} else if (option[PACKEDTABLES]) {
+		bits = print_packed_g(nbperf, state);
+	} else {
 	/*if (state->graph.v >= 4294967295U) { // 32bit only
 		g_type = "uint64_t";
 		g_width = 16;
@@ -165,20 +426,29 @@ print_hash(struct nbperf *nbperf, struct SIZED(state) *state)
 		g_width = 2;
 		per_line = 10;
 	}
-	out->add_hash_body ("\tstatic %s %s g[%" PRId32 "] = {\n",
+	if (option[BINARYTABLES]) {
+		print_binary_g(nbperf, state, g_type, g_width / 2);
+	} else {
+	out->add_hash_body ("\tstatic %s %s g[%" PRId32 "]%s = {\n",
 			       option[KRC] ? "" : "const",
-			       g_type, state->graph.v);
-	for (i = 0; i < state->graph.v; ++i) {
-		out->add_hash_body ("%s0x%0*" PRIx32 ",%s",
-				       (i % per_line == 0 ? "\t    " : " "),
-				       g_width, state->g[i],
-				       (i % per_line == per_line - 1 ? "\n" : ""));
-	}
-	if (i % per_line != 0)
+			       g_type, state->graph.v,
+			       option[ALIGNEDTABLES] ? " GPERF_ALIGNED" : "");
+	table.values32 = state->g;
+	table.values64 = NULL;
+	table.digits = g_width;
+	table.per_line = per_line;
+	table.indent = "\t    ";
+	out->hash_body ().put_table (state->graph.v, print_hex_entries, &table,
+	    option.get_threads ());
+	if (state->graph.v % per_line != 0)
 		out->add_hash_body ("\n\t};\n");
 	else
 		out->add_hash_body ("\t};\n");
-	out->add_hash_body ("\tuint32_t h[%zu];\n\n", nbperf->hash_size);
+	}
+	}
+	if (!option[JAVASCRIPT] && !option[CONSTEXPR])
+		out->add_hash_body ("\tuint32_t h[%zu];\n\n",
+		    nbperf->hash_size);
 	(*nbperf->print_hash)(nbperf, "\t", "str", "len", "h");
 
 	out->add_hash_body ("\n\th[0] = h[0] %% %" PRIu32 ";\n",
@@ -202,6 +472,25 @@ print_hash(struct nbperf *nbperf, struct SIZED(state) *state)
 	}
 #endif
 
+	if (option[PACKEDTABLES]) {
+		/* Replace each vertex by its g value, from the bits
+		   bits * h ... bits * h + bits - 1.  */
+		for (i = 0; i < GRAPH_SIZE; ++i)
+			out->add_hash_body (
+			    "\tbit = (uint64_t)h[%" PRIu32 "] * %d;\n"
+			    "\th[%" PRIu32 "] = ((g[bit >> 6] >> (bit & 63))\n"
+			    "\t        | (g[(bit >> 6) + 1] << 1 << (~bit & 63)))"
+			    " & 0x%" PRIx32 ";\n",
+			    i, bits, i,
+			    (uint32_t)(((uint64_t)1 << bits) - 1));
+#if GRAPH_SIZE >= 3
+		out->add_hash_body ("\treturn (h[0] + h[1] + h[2]) %% "
+		    "%" PRIu32 ";\n", state->graph.e);
+#else
+		out->add_hash_body ("\treturn (h[0] + h[1]) %% "
+		    "%" PRIu32 ";\n", state->graph.e);
+#endif
+	} else {
 #if GRAPH_SIZE >= 3
 	out->add_hash_body ("\treturn (g[h[0]] + g[h[1]] + g[h[2]]) %% "
 	    "%" PRIu32 ";\n", state->graph.e);
@@ -209,6 +498,7 @@ print_hash(struct nbperf *nbperf, struct SIZED(state) *state)
 	out->add_hash_body ("\treturn (g[h[0]] + g[h[1]]) %% "
 	    "%" PRIu32 ";\n", state->graph.e);
 #endif
+	}
 	assert(nbperf->n == state->graph.e);
 }
 
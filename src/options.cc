@@ -192,6 +192,43 @@ Options::long_usage (FILE * stream)
            "  -Q, --string-pool-name=NAME\n"
            "                         Specify name of string pool generated by option --pic.\n"
            "                         Default name is 'stringpool'.\n");
+  fprintf (stream,
+           "      --merged-string-pool\n"
+           "                         Like --pic, but store keywords that are suffixes of\n"
+           "                         other keywords only once, and use the smallest\n"
+           "                         integer type for the string pool offsets.\n");
+  fprintf (stream,
+           "      --split-table      With -t, put the keys into an array of their own,\n"
+           "                         separate from the array of structs.\n");
+  fprintf (stream,
+           "      --fingerprints=BITS\n"
+           "                         Check an 8 or 16 bit fingerprint of the key before\n"
+           "                         comparing strings. This speeds up lookups of words\n"
+           "                         that are mostly not keywords.\n");
+  fprintf (stream,
+           "      --aligned-tables   Align the generated tables to 64-byte cache lines,\n"
+           "                         and interleave the BPZ tables that are read\n"
+           "                         together.\n");
+  fprintf (stream,
+           "      --packed-tables    With --chm and --chm3, bit pack the g[] table into\n"
+           "                         as many bits per entry as its values need.\n");
+  fprintf (stream,
+           "      --binary-tables=FILE\n"
+           "                         With --chm, --chm3 and --bpz, write the tables to\n"
+           "                         the binary FILE, and generate code that maps FILE\n"
+           "                         at run time instead of compiling the tables in.\n");
+  fprintf (stream,
+           "      --embed-tables=FILE\n"
+           "                         Like --binary-tables, but embed FILE into the\n"
+           "                         generated code with #embed or .incbin.\n");
+  fprintf (stream,
+           "      --constexpr        With -L C++, generate C++17 code with constexpr\n"
+           "                         tables and constexpr functions that take a\n"
+           "                         std::string_view.\n");
+  fprintf (stream,
+           "      --class-template   Like --constexpr, but generate a class template\n"
+           "                         with a noexcept find method, which returns the\n"
+           "                         index of the keyword.\n");
   fprintf (stream,
            "      --null-strings     Use NULL strings instead of empty strings for empty\n"
            "                         keyword table entries.\n");
@@ -225,6 +262,16 @@ Options::long_usage (FILE * stream)
            "                         the elements in each table, etc. If COUNT is very\n"
            "                         large, say 1000000, the generated C code does a\n"
            "                         binary search.\n");
+  fprintf (stream,
+           "      --switch-by-length Like -S, but switch on the length first, then in\n"
+           "                         each length on the hash value, and compare once\n"
+           "                         after the switch, with memcmp.\n");
+  fprintf (stream,
+           "      --cascade[=auto]   Instead of the hash function, switch on the length\n"
+           "                         and on the characters in which the keywords differ,\n"
+           "                         and compare with memcmp.  With auto, only if a\n"
+           "                         microbenchmark finds this faster than the hash\n"
+           "                         table, for at most 64 keywords.\n");
   fprintf (stream,
            "  --chm                  Use the CHM algorithm, which creates order preserving,\n"
            "                         optimal minimal perfect hashes (MPH)\n"
@@ -251,6 +298,10 @@ Options::long_usage (FILE * stream)
            "  --no-padding\n"
            "                         Disabled padding of the keyword strings with chm, chm2\n"
            "                         or bpz, which is only needed with asan or valgrind.\n\n");
+  fprintf (stream,
+           "  --threads=N\n"
+           "                         Format the large tables of chm, chm2 and bpz on N\n"
+           "                         threads. 0 means one per processor. Default 1.\n\n");
   fprintf (stream,
            "  -k, --key-positions=KEYS\n"
            "                         Select the key positions used in the hash function.\n"
@@ -271,6 +322,12 @@ Options::long_usage (FILE * stream)
            "                         and choose the best results. This increases the\n"
            "                         running time by a factor of ITERATIONS but does a\n"
            "                         good job minimizing the generated table size.\n");
+  fprintf (stream,
+           "      --time-budget=SECONDS\n"
+           "                         Keep trying choices of the -i and -j values, like\n"
+           "                         -m, until SECONDS of search time have been spent,\n"
+           "                         and choose the best results. Together with -m, stop\n"
+           "                         at whichever limit is reached first.\n");
   fprintf (stream,
            "  -i, --initial-asso=N   Provide an initial value for the associate values\n"
            "                         array. Default is 0. Setting this value larger helps\n"
@@ -506,13 +563,18 @@ PositionStringParser::nextPosition ()
 
 Options::Options ()
   : _option_word (ANSIC),
+    _option_word2 (0),
     _input_file_name (NULL),
     _output_file_name (NULL),
+    _binary_tables_file_name (NULL),
     _language (NULL),
     _jump (DEFAULT_JUMP_VALUE),
     _initial_asso_value (0),
     _asso_iterations (0),
+    _time_budget (0.0f),
     _total_switches (1),
+    _fingerprint_bits (0),
+    _threads (1),
     _size_multiple (1.0f),
     _function_name (DEFAULT_FUNCTION_NAME),
     _slot_name (DEFAULT_SLOT_NAME),
@@ -525,7 +587,8 @@ Options::Options ()
     _constants_prefix (DEFAULT_CONSTANTS_PREFIX),
     _delimiters (DEFAULT_DELIMITERS),
     _key_positions (),
-    _mph_hash_function (DEFAULT_MPH_HASH_FUNCTION)
+    _mph_hash_function (DEFAULT_MPH_HASH_FUNCTION),
+    _mph_hash_function_given (false)
 {
   memset(&_nbperf, 0, sizeof(struct nbperf));
   _nbperf.hash_name = DEFAULT_HASH_NAME;
@@ -556,6 +619,17 @@ Options::~Options ()
                "\nGLOBAL is.......: %s"
                "\nNULLSTRINGS is..: %s"
                "\nSHAREDLIB is....: %s"
+               "\nMERGEDPOOL is...: %s"
+               "\nSPLITTABLE is...: %s"
+               "\nALIGNEDTABLES is: %s"
+               "\nPACKEDTABLES is.: %s"
+               "\nBINARYTABLES is.: %s"
+               "\nEMBEDTABLES is..: %s"
+               "\nCONSTEXPR is....: %s"
+               "\nCLASSTEMPLATE is: %s"
+               "\nSWITCHBYLENGTH .: %s"
+               "\nCASCADE is......: %s"
+               "\nCASCADEAUTO is..: %s"
                "\nALGORITHM is....: %s"
                "\nSWITCH is.......: %s"
                "\nNOTYPE is.......: %s"
@@ -574,11 +648,14 @@ Options::~Options ()
                "\nslot name = %s"
                "\ninitializer suffix = %s"
                "\nasso_values iterations = %d"
+               "\ntime budget = %g"
                "\njump value = %d"
                "\nhash table size multiplier = %g"
                "\ninitial associated value = %d"
                "\ndelimiters = %s"
-               "\nnumber of switch statements = %d\n",
+               "\nnumber of switch statements = %d"
+               "\nfingerprint bits = %d"
+               "\nnumber of threads = %d\n",
                _option_word & TYPE ? "enabled" : "disabled",
                _option_word & UPPERLOWER ? "enabled" : "disabled",
                _option_word & KRC ? "enabled" : "disabled",
@@ -596,6 +673,17 @@ Options::~Options ()
                _option_word & GLOBAL ? "enabled" : "disabled",
                _option_word & NULLSTRINGS ? "enabled" : "disabled",
                _option_word & SHAREDLIB ? "enabled" : "disabled",
+               _option_word & MERGEDPOOL ? "enabled" : "disabled",
+               _option_word & SPLITTABLE ? "enabled" : "disabled",
+               _option_word & ALIGNEDTABLES ? "enabled" : "disabled",
+               _option_word2 & PACKEDTABLES ? "enabled" : "disabled",
+               _option_word2 & BINARYTABLES ? "enabled" : "disabled",
+               _option_word2 & EMBEDTABLES ? "enabled" : "disabled",
+               _option_word2 & CONSTEXPR ? "enabled" : "disabled",
+               _option_word2 & CLASSTEMPLATE ? "enabled" : "disabled",
+               _option_word2 & SWITCHBYLENGTH ? "enabled" : "disabled",
+               _option_word2 & CASCADE ? "enabled" : "disabled",
+               _option_word2 & CASCADEAUTO ? "enabled" : "disabled",
                _option_word & SWITCH ? "switch" :
                  _option_word & CHM_ALGO ? "chm" :
                  _option_word & CHM3_ALGO ? "chm3" :
@@ -616,8 +704,9 @@ Options::~Options ()
                _mph_hash_function == e_crc ? "crc" : "<invalid>",
                _wordlist_name, _lengthtable_name,
                _stringpool_name, _slot_name, _initializer_suffix,
-               _asso_iterations, _jump, _size_multiple, _initial_asso_value,
-               _delimiters, _total_switches);
+               _asso_iterations, _time_budget, _jump, _size_multiple,
+               _initial_asso_value,
+               _delimiters, _total_switches, _fingerprint_bits, _threads);
       if (_key_positions.is_useall())
         fprintf (stderr, "all characters are used in the hash function\n");
       else
@@ -686,14 +775,17 @@ extern "C" {
   static void wyhash_compute(struct nbperf *nbperf, const void *key, size_t keylen,
                              uint32_t *hashes)
   {
-    wyhash3(key, keylen, *(uint64_t*)nbperf->seed, (uint64_t*)hashes);
+    wyhash3(key, keylen, *(uint64_t*)nbperf->seed, hashes);
   }
+  /* With --ignore-case, the keys were folded to lower case, and the
+     generated code folds the input while hashing it.  */
   static void wyhash_print(struct nbperf *nbperf, const char *indent,
                            const char *key, const char *keylen, const char *hash)
   {
     Output *out = nbperf->out;
-    out->add_hash_body ("%swyhash3(%s, %s, UINT64_C(0x%" PRIx64 "), (uint64_t *)%s);\n",
-                        indent, key, keylen, *(uint64_t*)nbperf->seed, hash);
+    out->add_hash_body ("%swyhash3%s(%s, %s, UINT64_C(0x%" PRIx64 "), %s);\n",
+                        indent, option[UPPERLOWER] ? "_lower" : "",
+                        key, keylen, *(uint64_t*)nbperf->seed, hash);
   }
 
   static void fnv_compute(struct nbperf *nbperf, const void *key, size_t keylen,
@@ -711,14 +803,108 @@ extern "C" {
   static void fnv3_compute(struct nbperf *nbperf, const void *key, size_t keylen,
                           uint32_t *hashes)
   {
-    fnv3(key, keylen, *(uint64_t*)nbperf->seed, (uint64_t*)hashes);
+    fnv3(key, keylen, *(uint64_t*)nbperf->seed, hashes);
   }
   static void fnv3_print(struct nbperf *nbperf, const char *indent,
                         const char *key, const char *keylen, const char *hash)
   {
     Output *out = nbperf->out;
-    out->add_hash_body ("%sfnv3(%s, %s, UINT64_C(0x%" PRIx64 "), %s);\n",
-                        indent, key, keylen, *(uint64_t*)nbperf->seed, hash);
+    out->add_hash_body ("%sfnv3%s(%s, %s, UINT64_C(0x%" PRIx64 "), %s);\n",
+                        indent, option[UPPERLOWER] ? "_lower" : "",
+                        key, keylen, *(uint64_t*)nbperf->seed, hash);
+  }
+  /* Emits fnv3 in JavaScript, for a string of UTF-16 code units, which are
+     the bytes of the keyword for the keywords.  The 64-bit FNV multiply by
+     2^40 + 0x1b3 is done on 32-bit halves: LO * 0x1b3 is exact in a double,
+     and its upper part carries into HI.  The three hash values are stored
+     into the Uint32Array HASH.  */
+  static void fnv3_print_javascript(struct nbperf *nbperf, const char *indent,
+                                    const char *key, const char *keylen,
+                                    const char *hash)
+  {
+    Output *out = nbperf->out;
+    uint64_t seed = *(uint64_t*)nbperf->seed;
+    uint64_t h0 = seed ^ UINT64_C(0xcbf29ce484222325);
+    uint64_t h1 = seed ^ UINT64_C(0xc4ceb9fe1a85ec53);
+    (void) keylen;
+    out->add_hash_body ("%svar lo0 = 0x%08" PRIx32 ", hi0 = 0x%08" PRIx32 ","
+                        " lo1 = 0x%08" PRIx32 ", hi1 = 0x%08" PRIx32 ";\n"
+                        "%svar c, t;\n"
+                        "%sfor (var i = 0; i < %s.length; i++) {\n"
+                        "%s  c = %s.charCodeAt(i);\n"
+                        "%s  lo0 ^= c;\n"
+                        "%s  t = (lo0 >>> 0) * 0x1b3;\n"
+                        "%s  hi0 = Math.imul(hi0, 0x1b3) + (lo0 << 8) + (t / 0x100000000 | 0) | 0;\n"
+                        "%s  lo0 = t | 0;\n"
+                        "%s  lo1 ^= c;\n"
+                        "%s  t = (lo1 >>> 0) * 0x1b3;\n"
+                        "%s  hi1 = Math.imul(hi1, 0x1b3) + (lo1 << 8) + (t / 0x100000000 | 0) | 0;\n"
+                        "%s  lo1 = t | 0;\n"
+                        "%s}\n"
+                        "%s%s[0] = lo0;\n"
+                        "%s%s[1] = hi0;\n"
+                        "%s%s[2] = lo1;\n",
+                        indent, (uint32_t) h0, (uint32_t) (h0 >> 32),
+                        (uint32_t) h1, (uint32_t) (h1 >> 32),
+                        indent, indent, key, indent, key,
+                        indent, indent, indent, indent,
+                        indent, indent, indent, indent, indent,
+                        indent, hash, indent, hash, indent, hash);
+  }
+  /* Emits fnv3 in Lua 5.3, whose integers are 64 bits wide and wrap
+     around, like uint64_t.  The three hash values, the halves of the first
+     64-bit hash and the lower half of the second, are stored into the
+     locals HASH0, HASH1 and HASH2, since a table would be allocated by
+     every call.  */
+  static void fnv3_print_lua(struct nbperf *nbperf, const char *indent,
+                             const char *key, const char *keylen,
+                             const char *hash)
+  {
+    Output *out = nbperf->out;
+    uint64_t seed = *(uint64_t*)nbperf->seed;
+    (void) keylen;
+    out->add_hash_body ("%slocal %s0, %s1 = 0x%016" PRIx64 ", 0x%016" PRIx64 "\n"
+                        "%sfor i = 1, #%s do\n"
+                        "%s    local c = byte(%s, i)\n"
+                        "%s    %s0 = (%s0 ~ c) * 0x100000001b3\n"
+                        "%s    %s1 = (%s1 ~ c) * 0x100000001b3\n"
+                        "%send\n"
+                        "%slocal %s2 = %s1 & 0xffffffff\n"
+                        "%s%s1 = %s0 >> 32\n"
+                        "%s%s0 = %s0 & 0xffffffff\n",
+                        indent, hash, hash,
+                        seed ^ UINT64_C(0xcbf29ce484222325),
+                        seed ^ UINT64_C(0xc4ceb9fe1a85ec53),
+                        indent, key, indent, key,
+                        indent, hash, hash, indent, hash, hash, indent,
+                        indent, hash, hash, indent, hash, hash,
+                        indent, hash, hash);
+  }
+  /* Emits fnv3 in constexpr C++, on the std::string_view KEY.  The three
+     hash values are stored into the array HASH, which is declared here,
+     since a constexpr function may not have uninitialized variables before
+     C++20.  */
+  static void fnv3_print_constexpr(struct nbperf *nbperf, const char *indent,
+                                   const char *key, const char *keylen,
+                                   const char *hash)
+  {
+    Output *out = nbperf->out;
+    uint64_t seed = *(uint64_t*)nbperf->seed;
+    (void) keylen;
+    out->add_hash_body ("%suint64_t h0 = UINT64_C(0x%016" PRIx64 ");\n"
+                        "%suint64_t h1 = UINT64_C(0x%016" PRIx64 ");\n"
+                        "%sfor (unsigned char c : %s)\n"
+                        "%s  {\n"
+                        "%s    h0 = (h0 ^ c) * UINT64_C(0x100000001b3);\n"
+                        "%s    h1 = (h1 ^ c) * UINT64_C(0x100000001b3);\n"
+                        "%s  }\n"
+                        "%suint32_t %s[3] = { static_cast<uint32_t>(h0),\n"
+                        "%s                  static_cast<uint32_t>(h0 >> 32),\n"
+                        "%s                  static_cast<uint32_t>(h1) };\n",
+                        indent, seed ^ UINT64_C(0xcbf29ce484222325),
+                        indent, seed ^ UINT64_C(0xc4ceb9fe1a85ec53),
+                        indent, key, indent, indent, indent, indent,
+                        indent, hash, indent, indent);
   }
   static void crc_compute(struct nbperf *nbperf, const void *key, size_t keylen,
                           uint32_t *hashes)
@@ -775,6 +961,14 @@ Options::set_total_switches (int total_switches)
     }
 }
 
+/* Sets the width of the keyword fingerprints.  */
+void
+Options::set_fingerprint_bits (int fingerprint_bits)
+{
+  if (_fingerprint_bits == 0)
+    _fingerprint_bits = fingerprint_bits;
+}
+
 /* Sets the generated function name.  */
 void
 Options::set_function_name (const char *name)
@@ -878,7 +1072,10 @@ Options::set_nbperf ()
   } else if (_mph_hash_function == e_fnv3) {
     _nbperf.seed_hash = large_seed;
     _nbperf.compute_hash = fnv3_compute;
-    _nbperf.print_hash = fnv3_print;
+    _nbperf.print_hash =
+      _option_word & JAVASCRIPT ? fnv3_print_javascript :
+      _option_word & LUA ? fnv3_print_lua :
+      _option_word2 & CONSTEXPR ? fnv3_print_constexpr : fnv3_print;
   } else if (_mph_hash_function == e_crc) {
     _nbperf.seed_hash = large_seed;
     _nbperf.compute_hash = crc_compute;
@@ -903,6 +1100,20 @@ Options::set_nbperf ()
     _nbperf.output = stdout;
 }
 
+/* Sets the MPH hash function, if not already set by
+   --mph-hash-function.  */
+void
+Options::set_mph_hash_function (enum Option_Mph_Hash_Function hash_function)
+{
+  if (!_mph_hash_function_given)
+    {
+      _mph_hash_function = hash_function;
+      if (hash_function != e_jenkins)
+        _option_word &= ~PADDING;
+      set_nbperf ();
+    }
+}
+
 /* Parses the command line Options and sets appropriate flags in option_word.  */
 
 static const struct option long_options[] =
@@ -943,6 +1154,11 @@ static const struct option long_options[] =
   { "optimized-collision-resolution", no_argument, NULL, 'O' },
   { "pic", no_argument, NULL, 'P' },
   { "string-pool-name", required_argument, NULL, 'Q' },
+  { "merged-string-pool", no_argument, NULL, CHAR_MAX + 12 },
+  { "split-table", no_argument, NULL, CHAR_MAX + 13 },
+  { "fingerprints", required_argument, NULL, CHAR_MAX + 14 },
+  { "aligned-tables", no_argument, NULL, CHAR_MAX + 15 },
+  { "packed-tables", no_argument, NULL, CHAR_MAX + 16 },
   { "null-strings", no_argument, NULL, CHAR_MAX + 3 },
   { "random", no_argument, NULL, 'r' },
   { "size-multiple", required_argument, NULL, 's' },
@@ -953,6 +1169,14 @@ static const struct option long_options[] =
   { "utilisation", required_argument, NULL, 'u' },
   { "allow-hash-fudging", no_argument, NULL, 'f' },
   { "no-padding", no_argument, NULL, CHAR_MAX + 10 },
+  { "time-budget", required_argument, NULL, CHAR_MAX + 11 },
+  { "threads", required_argument, NULL, CHAR_MAX + 17 },
+  { "binary-tables", required_argument, NULL, CHAR_MAX + 18 },
+  { "embed-tables", required_argument, NULL, CHAR_MAX + 19 },
+  { "constexpr", no_argument, NULL, CHAR_MAX + 20 },
+  { "class-template", no_argument, NULL, CHAR_MAX + 21 },
+  { "switch-by-length", no_argument, NULL, CHAR_MAX + 22 },
+  { "cascade", optional_argument, NULL, CHAR_MAX + 23 },
   { "help", no_argument, NULL, 'h' },
   { "version", no_argument, NULL, 'v' },
   { "debug", no_argument, NULL, 'd' },
@@ -1437,6 +1661,7 @@ There is NO WARRANTY, to the extent permitted by law.\n\
 	      _mph_hash_function = e_fnv3;
 	    else
 	      _mph_hash_function = e_crc;
+	    _mph_hash_function_given = true;
 	    set_nbperf ();
             break;
 	  }
@@ -1445,6 +1670,113 @@ There is NO WARRANTY, to the extent permitted by law.\n\
             option.unset(PADDING);
             break;
           }
+        case CHAR_MAX + 11:     /* Seconds for finding good asso_values.  */
+          {
+            if ((_time_budget = atof (/*getopt*/optarg)) < 0)
+              {
+                fprintf (stderr, "time budget must not be negative, assuming 0\n");
+                _time_budget = 0;
+              }
+            break;
+          }
+        case CHAR_MAX + 12:     /* Merge common suffixes in the string pool.  */
+          {
+            _option_word |= SHAREDLIB | MERGEDPOOL;
+            break;
+          }
+        case CHAR_MAX + 13:     /* Separate keys from the struct table.  */
+          {
+            _option_word |= SPLITTABLE;
+            break;
+          }
+        case CHAR_MAX + 14:     /* Width of the keyword fingerprints.  */
+          {
+            _fingerprint_bits = atoi (/*getopt*/optarg);
+            if (_fingerprint_bits != 8 && _fingerprint_bits != 16)
+              {
+                fprintf (stderr, "fingerprint width %s must be 8 or 16\n", /*getopt*/optarg);
+                short_usage (stderr);
+                exit (1);
+              }
+            break;
+          }
+        case CHAR_MAX + 15:     /* Align and interleave the tables.  */
+          {
+            _option_word |= ALIGNEDTABLES;
+            break;
+          }
+        case CHAR_MAX + 16:     /* Bit pack the g[] table.  */
+          {
+            _option_word2 |= PACKEDTABLES;
+            break;
+          }
+        case CHAR_MAX + 17:     /* Threads for formatting the tables.  */
+          {
+            if ((_threads = atoi (/*getopt*/optarg)) < 0)
+              {
+                fprintf (stderr, "number of threads must not be negative, assuming 1\n");
+                _threads = 1;
+              }
+            break;
+          }
+        case CHAR_MAX + 18:     /* Write the tables to a binary file.  */
+          {
+            _binary_tables_file_name = /*getopt*/optarg;
+            _option_word2 |= BINARYTABLES;
+            /* The keywords are referenced as offsets into the string pool,
+               like with --pic.  */
+            _option_word |= SHAREDLIB;
+            break;
+          }
+        case CHAR_MAX + 19:     /* Embed the tables from a binary file.  */
+          {
+            _binary_tables_file_name = /*getopt*/optarg;
+            _option_word2 |= BINARYTABLES | EMBEDTABLES;
+            _option_word |= SHAREDLIB;
+            break;
+          }
+        case CHAR_MAX + 20:     /* Generate constexpr C++ code.  */
+          {
+            _option_word2 |= CONSTEXPR;
+            set_language ("C++");
+            break;
+          }
+        case CHAR_MAX + 21:     /* Generate a C++ class template.  */
+          {
+            _option_word2 |= CONSTEXPR | CLASSTEMPLATE;
+            set_language ("C++");
+            break;
+          }
+        case CHAR_MAX + 22:     /* Group the switch cases by length.  */
+          {
+            if (_option_word & (CHM_ALGO|CHM3_ALGO|BPZ_ALGO))
+              {
+                fprintf (stderr, "Invalid --%s, another algorithm already selected.\n", "switch-by-length");
+                short_usage (stderr);
+                exit (1);
+              }
+            _option_word2 |= SWITCHBYLENGTH;
+            set_total_switches (1);
+            break;
+          }
+        case CHAR_MAX + 23:     /* Replace the hash by a compare cascade.  */
+          {
+            if (/*getopt*/optarg == NULL)
+              {
+                _option_word2 |= CASCADE;
+                set_total_switches (1);
+              }
+            else if (strcmp (/*getopt*/optarg, "auto") == 0)
+              /* The output decides whether to switch.  */
+              _option_word2 |= CASCADE | CASCADEAUTO;
+            else
+              {
+                fprintf (stderr, "Invalid --cascade argument %s, only auto is supported.\n", /*getopt*/optarg);
+                short_usage (stderr);
+                exit (1);
+              }
+            break;
+          }
         default:
           short_usage (stderr);
           exit (1);
@@ -1452,6 +1784,63 @@ There is NO WARRANTY, to the extent permitted by law.\n\
 
     }
 
+  if ((_option_word2 & BINARYTABLES)
+      && !(_option_word & (CHM_ALGO|CHM3_ALGO|BPZ_ALGO)))
+    {
+      fprintf (stderr, "--binary-tables and --embed-tables only valid for MPH algorithms chm,chm3,bpz.\n");
+      short_usage (stderr);
+      exit (1);
+    }
+  if ((_option_word2 & CONSTEXPR) && !(_option_word & CPLUSPLUS))
+    {
+      fprintf (stderr, "--constexpr is only valid with -L C++.\n");
+      exit (1);
+    }
+  if ((_option_word2 & SWITCHBYLENGTH) && (_option_word & (JAVASCRIPT|LUA)))
+    {
+      fprintf (stderr, "--switch-by-length may not be used with -L JavaScript or -L Lua.\n");
+      exit (1);
+    }
+  if ((_option_word2 & CASCADE)
+      && ((_option_word & (JAVASCRIPT|LUA|CHM_ALGO|CHM3_ALGO|BPZ_ALGO))
+          || (_option_word2 & (CONSTEXPR|SWITCHBYLENGTH))))
+    {
+      fprintf (stderr, "--cascade may not be used with -L JavaScript, -L Lua, --constexpr, --switch-by-length or the MPH algorithms.\n");
+      exit (1);
+    }
+  if ((_option_word2 & BINARYTABLES)
+      && ((_option_word & (JAVASCRIPT|LUA|MERGEDPOOL))
+          || (_option_word2 & CONSTEXPR)))
+    {
+      fprintf (stderr, "--binary-tables and --embed-tables may not be used with -L JavaScript, -L Lua, --constexpr or --merged-string-pool.\n");
+      exit (1);
+    }
+
+  /* The JavaScript, Lua and constexpr C++ code of the MPH algorithms
+     implements only fnv3, which is therefore the default there.  */
+  if (((_option_word & (JAVASCRIPT|LUA)) || (_option_word2 & CONSTEXPR))
+      && (_option_word & (CHM_ALGO|CHM3_ALGO|BPZ_ALGO)))
+    {
+      const char *language =
+        _option_word & LUA ? "-L Lua" :
+        _option_word & JAVASCRIPT ? "-L JavaScript" : "--constexpr";
+      if (_mph_hash_function_given && _mph_hash_function != e_fnv3)
+        {
+          fprintf (stderr, "%s supports only --mph-hash-function=fnv3.\n",
+                   language);
+          exit (1);
+        }
+      if ((_option_word2 & PACKEDTABLES) || (_option_word & ALIGNEDTABLES))
+        {
+          fprintf (stderr, "--packed-tables and --aligned-tables may not be used with %s.\n",
+                   language);
+          exit (1);
+        }
+      _mph_hash_function = e_fnv3;
+      _option_word &= ~PADDING;
+      set_nbperf ();
+    }
+
   if (/*getopt*/optind < argc)
     _input_file_name = argv[/*getopt*/optind++];
 
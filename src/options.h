@@ -92,6 +92,16 @@ enum Option_Type
   /* Optimize for position-independent code.  */
   SHAREDLIB    = 1 << 16,
 
+  /* Merge common suffixes in the string pool of SHAREDLIB.  */
+  MERGEDPOOL   = 1 << 29,
+
+  /* Put the keys of a TYPE keyword table into a separate array.  */
+  SPLITTABLE   = 1 << 30,
+
+  /* Align the generated tables to cache lines, and interleave tables
+     that are read together.  */
+  ALIGNEDTABLES = 1U << 31,
+
   /* Generate switch output to save space.  */
   SWITCH       = 1 << 17,
 
@@ -134,6 +144,43 @@ enum Option_Type
   DEBUG        = 1 << 28
 };
 
+/* Enumeration of the further boolean options, for which Option_Type has
+   no bits left.  */
+
+enum Option_Type2
+{
+  /* --- Details in the output code --- */
+
+  /* Bit pack the g[] table of CHM and CHM3.  */
+  PACKEDTABLES = 1 << 0,
+
+  /* Write the MPH tables to a binary file, which the generated code maps
+     at run time.  */
+  BINARYTABLES = 1 << 1,
+
+  /* With BINARYTABLES, embed the binary file into the generated code.  */
+  EMBEDTABLES = 1 << 2,
+
+  /* Generate C++17 code with constexpr tables and functions, taking
+     std::string_view.  */
+  CONSTEXPR = 1 << 3,
+
+  /* With CONSTEXPR, generate a header-only class template with a find
+     method that returns the index of the keyword.  */
+  CLASSTEMPLATE = 1 << 4,
+
+  /* With SWITCH, switch on the length first, then on the hash value.  */
+  SWITCHBYLENGTH = 1 << 5,
+
+  /* Replace the hash by a switch on the length and on the characters in
+     which the keywords differ, and compare with memcmp.  */
+  CASCADE = 1 << 6,
+
+  /* With CASCADE, use it only if a microbenchmark finds it faster than the
+     hash table.  */
+  CASCADEAUTO = 1 << 7
+};
+
 enum Option_Mph_Hash_Function
 {
   e_jenkins,
@@ -168,6 +215,10 @@ public:
   void                  set (Option_Type option);
   /* Clears a given boolean option.  */
   void                  unset (Option_Type option);
+  /* Tests, sets and clears a given boolean option of Option_Type2.  */
+  bool                  operator[] (Option_Type2 option) const;
+  void                  set (Option_Type2 option);
+  void                  unset (Option_Type2 option);
 
   /* Returns true if CHM, CHM3, or BPZ.  */
   bool                  is_mph_algo () const;
@@ -182,6 +233,9 @@ public:
   /* Returns the output file name.  */
   const char *          get_output_file_name () const;
 
+  /* Returns the name of the binary tables file.  */
+  const char *          get_binary_tables_file_name () const;
+
   /* Sets the output language, if not already set.  */
   void                  set_language (const char *language);
 
@@ -194,11 +248,25 @@ public:
   /* Returns the number of iterations for finding good asso_values.  */
   int                   get_asso_iterations () const;
 
+  /* Returns the number of seconds that may be spent searching for good
+     asso_values, or 0 if there is no time budget.  */
+  float                 get_time_budget () const;
+
   /* Returns the total number of switch statements to generate.  */
   int                   get_total_switches () const;
   /* Sets the total number of switch statements, if not already set.  */
   void                  set_total_switches (int total_switches);
 
+  /* Returns the width of the keyword fingerprints, 8 or 16, or 0 if no
+     fingerprint table is generated.  */
+  int                   get_fingerprint_bits () const;
+  /* Sets the width of the keyword fingerprints, if not already set.  */
+  void                  set_fingerprint_bits (int fingerprint_bits);
+
+  /* Returns the number of threads for formatting the MPH tables, or 0 for
+     one per processor.  */
+  int                   get_threads () const;
+
   /* Returns the factor by which to multiply the generated table's size.  */
   float                 get_size_multiple () const;
 
@@ -209,6 +277,8 @@ public:
 
   /* Returns the selected MPH function name.  */
   const enum Option_Mph_Hash_Function get_mph_hash_function () const;
+  /* Sets the MPH hash function, if not already set.  */
+  void                  set_mph_hash_function (enum Option_Mph_Hash_Function hash_function);
 
   /* Returns the keyword key name.  */
   const char *          get_slot_name () const;
@@ -272,7 +342,9 @@ private:
   char **               _argument_vector;
 
   /* Holds the boolean options.  */
-  int                   _option_word;
+  unsigned int          _option_word;
+  /* Holds the boolean options of Option_Type2.  */
+  unsigned int          _option_word2;
 
   /* Name of input file.  */
   char *                _input_file_name;
@@ -280,6 +352,9 @@ private:
   /* Name of output file.  */
   char *                _output_file_name;
 
+  /* Name of the binary tables file.  */
+  char *                _binary_tables_file_name;
+
   /* The output language.  */
   const char *          _language;
 
@@ -292,9 +367,18 @@ private:
   /* Number of attempts at finding good asso_values.  */
   int                   _asso_iterations;
 
+  /* Number of seconds for finding good asso_values, or 0.  */
+  float                 _time_budget;
+
   /* Number of switch statements to generate.  */
   int                   _total_switches;
 
+  /* Width of the keyword fingerprints, or 0.  */
+  int                   _fingerprint_bits;
+
+  /* Number of threads for formatting the MPH tables, or 0.  */
+  int                   _threads;
+
   /* Factor by which to multiply the generated table's size.  */
   float                 _size_multiple;
 
@@ -334,6 +418,9 @@ private:
   /* Selected MPH hash function  */
   enum Option_Mph_Hash_Function _mph_hash_function;
 
+  /* True if the MPH hash function was given by --mph-hash-function.  */
+  bool                  _mph_hash_function_given;
+
   /* Contains the MPH-specific nbperf options.  */
   struct nbperf         _nbperf;
 };
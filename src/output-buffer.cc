@@ -0,0 +1,135 @@
+/* Growable character buffer for the generated code.
+
+   This file is part of GNU GPERF.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* Specification. */
+#include "output-buffer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <functional>
+#include <thread>
+#include <vector>
+
+/* Initializes an empty buffer.  */
+Output_Buffer::Output_Buffer ()
+  : _data (NULL), _size (0), _capacity (0)
+{
+}
+
+/* Frees this object.  */
+Output_Buffer::~Output_Buffer ()
+{
+  free (_data);
+}
+
+/* Reallocates the storage for at least N more characters.  */
+void
+Output_Buffer::grow (size_t n)
+{
+  size_t capacity = _capacity > 0 ? 2 * _capacity : 4096;
+  while (capacity - _size < n)
+    capacity *= 2;
+  char *data = static_cast<char *>(realloc (_data, capacity));
+  if (data == NULL)
+    {
+      fprintf (stderr, "virtual memory exhausted\n");
+      exit (1);
+    }
+  _data = data;
+  _capacity = capacity;
+}
+
+/* Appends the result of a printf format.  */
+void
+Output_Buffer::vprintf (const char *format, va_list args)
+{
+  va_list copy;
+  va_copy (copy, args);
+  int len = vsnprintf (_data + _size, _capacity - _size, format, copy);
+  va_end (copy);
+  if (len < 0)
+    {
+      fprintf (stderr, "invalid format string\n");
+      exit (1);
+    }
+  if ((size_t) len >= _capacity - _size)
+    {
+      /* Didn't fit, including the terminating NUL.  Retry with enough
+         room.  */
+      grow ((size_t) len + 1);
+      vsnprintf (_data + _size, _capacity - _size, format, args);
+    }
+  _size += len;
+}
+
+void
+Output_Buffer::printf (const char *format, ...)
+{
+  va_list args;
+  va_start (args, format);
+  vprintf (format, args);
+  va_end (args);
+}
+
+/* Appends the entries 0 ... COUNT-1 of a table, formatted by FORMAT.  */
+void
+Output_Buffer::put_table (size_t count, Formatter format, const void *data,
+                          int threads)
+{
+  if (threads == 0)
+    threads = std::thread::hardware_concurrency ();
+  if ((size_t) threads > count / OUTPUT_BUFFER_CHUNK_MIN)
+    threads = count / OUTPUT_BUFFER_CHUNK_MIN;
+  if (threads <= 1)
+    {
+      format (*this, 0, count, data);
+      return;
+    }
+
+  /* The calling thread formats the first chunk directly into this buffer,
+     the workers format the others into buffers of their own.  */
+  Output_Buffer *chunks = new Output_Buffer[threads];
+  std::vector<std::thread> workers;
+  for (int t = 1; t < threads; t++)
+    workers.push_back (std::thread (format, std::ref (chunks[t]),
+                                    count * t / threads,
+                                    count * (t + 1) / threads, data));
+  format (*this, 0, count / threads, data);
+  for (int t = 1; t < threads; t++)
+    {
+      workers[t - 1].join ();
+      put (chunks[t]._data, chunks[t]._size);
+    }
+  delete[] chunks;
+}
+
+/* Writes the contents to STREAM.  */
+void
+Output_Buffer::write (FILE *stream) const
+{
+  if (_size > 0)
+    fwrite (_data, 1, _size, stream);
+}
+
+#ifndef __OPTIMIZE__
+
+#define INLINE /* not inline */
+#include "output-buffer.icc"
+#undef INLINE
+
+#endif /* not defined __OPTIMIZE__ */
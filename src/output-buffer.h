@@ -0,0 +1,129 @@
+/* This may look like C code, but it is really -*- C++ -*- */
+
+/* Growable character buffer for the generated code.
+
+   This file is part of GNU GPERF.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#ifndef output_buffer_h
+#define output_buffer_h 1
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+/* An Output_Buffer collects a piece of the generated code in memory, so
+   that large tables are formatted without a printf call per entry and
+   written with a single fwrite.  The numbers in the tables are formatted
+   by put_decimal and put_hex, which produce the same text as the "%d"
+   and "%x" printf conversions.  */
+
+/* Size from which the table emitters flush the buffer to the output.  */
+#define OUTPUT_BUFFER_FLUSH_SIZE 65536
+
+/* Smallest number of table entries that put_table gives to a worker
+   thread.  */
+#ifndef OUTPUT_BUFFER_CHUNK_MIN
+#define OUTPUT_BUFFER_CHUNK_MIN 16384
+#endif
+
+class Output_Buffer
+{
+public:
+  /* Initializes an empty buffer.  */
+                        Output_Buffer ();
+
+  /* Frees this object.  */
+                        ~Output_Buffer ();
+
+  /* Appends a character.  */
+  void                  put (char c);
+
+  /* Appends a NUL terminated string.  */
+  void                  put (const char *s);
+
+  /* Appends the LEN bytes starting at S.  */
+  void                  put (const char *s, size_t len);
+
+  /* Appends VALUE in decimal, right justified in a field of at least WIDTH
+     characters, like "%*d".  */
+  void                  put_decimal (int64_t value, int width);
+
+  /* Appends VALUE in lowercase hexadecimal, zero padded to at least DIGITS
+     digits, like "%0*llx".  */
+  void                  put_hex (uint64_t value, int digits);
+
+  /* Appends the result of a printf format.  */
+  void                  printf (const char *format, ...)
+#if defined __GNUC__
+                        __attribute__ ((__format__ (__printf__, 2, 3)))
+#endif
+                        ;
+  void                  vprintf (const char *format, va_list args);
+
+  /* Formats the entries START ... END-1 of a table into BUF.  */
+  typedef void          (*Formatter) (Output_Buffer& buf, size_t start,
+                                      size_t end, const void *data);
+
+  /* Appends the entries 0 ... COUNT-1 of a table, formatted by FORMAT.
+     With THREADS > 1, a large table is cut into THREADS chunks, which are
+     formatted in parallel and appended in order.  THREADS = 0 means one
+     thread per processor.  */
+  void                  put_table (size_t count, Formatter format,
+                                   const void *data, int threads);
+
+  /* Returns the number of characters in the buffer.  */
+  size_t                size () const;
+
+  /* Returns the characters in the buffer.  Not NUL terminated.  */
+  const char *          data () const;
+
+  /* Writes the contents to STREAM.  */
+  void                  write (FILE *stream) const;
+
+  /* Empties the buffer.  */
+  void                  clear ();
+
+  /* Writes the contents to STREAM and empties the buffer, if they have
+     grown beyond OUTPUT_BUFFER_FLUSH_SIZE.  */
+  void                  flush_if_large (FILE *stream);
+
+private:
+  /* Makes room for N more characters.  */
+  void                  reserve (size_t n);
+
+  /* Reallocates the storage for at least N more characters.  */
+  void                  grow (size_t n);
+
+  /* The characters.  Not NUL terminated.  */
+  char *                _data;
+
+  /* Number of characters in _data.  */
+  size_t                _size;
+
+  /* Allocated size of _data.  */
+  size_t                _capacity;
+};
+
+#ifdef __OPTIMIZE__
+
+#define INLINE inline
+#include "output-buffer.icc"
+#undef INLINE
+
+#endif
+
+#endif
@@ -0,0 +1,687 @@
+#include <stdio.h>
+
+/* Specification. */
+#include "output-cxx.h"
+
+#include <ctype.h>  /* declares isprint() */
+#include <stdio.h>
+#include <stdlib.h> /* declares exit(), free() */
+#include <string.h> /* declares memchr(), strlen() */
+#include <vector>
+#include "options.h"
+#include "version.h"
+#include "nbperf.h"
+
+using std::vector;
+
+OutputCxx::OutputCxx (KeywordExt_List *head,
+                      const char *struct_decl,
+                      unsigned int struct_decl_lineno,
+                      const char *return_type,
+                      const char *struct_tag,
+                      const char *verbatim_declarations,
+                      const char *verbatim_declarations_end,
+                      unsigned int verbatim_declarations_lineno,
+                      const char *verbatim_code,
+                      const char *verbatim_code_end,
+                      unsigned int verbatim_code_lineno,
+                      bool charset_dependent,
+                      int total_keys,
+                      int max_key_len, int min_key_len,
+                      bool hash_includes_len,
+                      const Positions& positions,
+                      const unsigned int *alpha_inc,
+                      int total_duplicates,
+                      unsigned int alpha_size,
+                      const int *asso_values)
+  : Output(head, struct_decl, struct_decl_lineno, return_type, struct_tag,
+      verbatim_declarations, verbatim_declarations_end,
+      verbatim_declarations_lineno, verbatim_code, verbatim_code_end,
+      verbatim_code_lineno, charset_dependent, total_keys, max_key_len,
+      min_key_len, hash_includes_len, positions, alpha_inc, total_duplicates,
+      alpha_size, asso_values)
+{
+}
+
+/* Returns the smallest unsigned integral type that can hold the values
+   0 ... MAX_VALUE.  */
+
+static const char *
+smallest_unsigned_type (int max_value)
+{
+  if (max_value < 256)
+    return "unsigned char";
+  if (max_value < 65536)
+    return "unsigned short";
+  return "unsigned int";
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Outputs the maximum and minimum hash values etc.  */
+
+void
+OutputCxx::output_constants () const
+{
+  const char *prefix = option.get_constants_prefix ();
+
+  printf ("  static constexpr unsigned int %sTOTAL_KEYWORDS = %d;\n"
+          "  static constexpr unsigned int %sMIN_WORD_LENGTH = %d;\n"
+          "  static constexpr unsigned int %sMAX_WORD_LENGTH = %d;\n"
+          "  static constexpr unsigned int %sMIN_HASH_VALUE = %d;\n"
+          "  static constexpr unsigned int %sMAX_HASH_VALUE = %d;\n"
+          "  /* maximum key range = %d, duplicates = %d */\n",
+          prefix, _total_keys,
+          prefix, _min_key_len,
+          prefix, _max_key_len,
+          prefix, _min_hash_value,
+          prefix, _max_hash_value,
+          _max_hash_value - _min_hash_value + 1, _total_duplicates);
+}
+
+/* Outputs the declarations of the lookup functions, and with HASH also of
+   the hash function.  */
+
+void
+OutputCxx::output_function_declarations (bool hash) const
+{
+  if (hash)
+    printf ("  static constexpr unsigned int %s (std::string_view str)%s;\n",
+            option.get_hash_name (), _noexcept);
+  else
+    {
+      if (option[CLASSTEMPLATE])
+        printf ("  static std::size_t find (std::string_view str) noexcept;\n");
+      printf ("  static constexpr %s%s (std::string_view str)%s;\n"
+              "  static constexpr %s%s (const char *str, std::size_t len)%s;\n",
+              _return_type, option.get_function_name (), _noexcept,
+              _return_type, option.get_function_name (), _noexcept);
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Outputs the asso_values table.  */
+
+void
+OutputCxx::output_asso_values () const
+{
+  if (!option.is_mph_algo() && _key_positions.get_size() > 0)
+    {
+      /* The values in the asso_values array are all unsigned integers
+         <= MAX_HASH_VALUE + 1.  */
+      printf ("  static constexpr %s asso_values[] =\n"
+              "    {",
+              smallest_unsigned_type (_max_hash_value + 1));
+
+      const int columns = 10;
+
+      /* Calculate maximum number of digits required for MAX_HASH_VALUE + 1.  */
+      int field_width = 2;
+      for (int trunc = _max_hash_value + 1; (trunc /= 10) > 0;)
+        field_width++;
+
+      Output_Buffer buf;
+      for (unsigned int count = 0; count < _alpha_size; count++)
+        {
+          if (count > 0)
+            buf.put (',');
+          if ((count % columns) == 0)
+            buf.put ("\n     ");
+          buf.put_decimal (_asso_values[count], field_width);
+          buf.flush_if_large (stdout);
+        }
+      buf.write (stdout);
+
+      printf ("\n"
+              "    };\n");
+    }
+}
+
+/* Generates a C++ expression for an asso_values[] reference.  */
+
+void
+OutputCxx::output_asso_values_ref (int pos) const
+{
+  printf ("asso_values[static_cast<unsigned char>(");
+  if (pos == Positions::LASTCHAR)
+    printf ("str[str.size () - 1]");
+  else
+    {
+      printf ("str[%d]", pos);
+      if (_alpha_inc[pos])
+        printf ("+%u", _alpha_inc[pos]);
+    }
+  printf (")]");
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Outputs a keyword, as a string: enclosed in double quotes, escaping
+   backslashes, double quote and unprintable characters.  */
+
+static void
+output_string (Output_Buffer& buf, const char *key, int len)
+{
+  buf.put ('"');
+  for (; len > 0; len--)
+    {
+      unsigned char c = static_cast<unsigned char>(*key++);
+      if (isprint (c))
+        {
+          if (c == '"' || c == '\\')
+            buf.put ('\\');
+          buf.put (c);
+        }
+      else
+        {
+          /* Use octal escapes, not hexadecimal escapes, because hexadecimal
+             escapes are not limited to 2 digits, thus needing special care
+             if the following character happens to be a digit.  */
+          char escape[4];
+          escape[0] = '\\';
+          escape[1] = '0' + ((c >> 6) & 7);
+          escape[2] = '0' + ((c >> 3) & 7);
+          escape[3] = '0' + (c & 7);
+          buf.put (escape, 4);
+        }
+    }
+  buf.put ('"');
+}
+
+static void
+output_keyword_entry (Output_Buffer& buf, const KeywordExt *keyword)
+{
+  buf.put ("      ");
+  if (option[TYPE])
+    {
+      buf.put ('{');
+      output_string (buf, keyword->_allchars, keyword->_allchars_length);
+      if (strlen (keyword->_rest) > 0)
+        {
+          buf.put (',');
+          buf.put (keyword->_rest);
+        }
+      buf.put ('}');
+    }
+  else if (memchr (keyword->_allchars, '\0', keyword->_allchars_length))
+    {
+      /* The std::string_view constructor from a string stops at the first
+         NUL.  */
+      buf.put ("std::string_view (");
+      output_string (buf, keyword->_allchars, keyword->_allchars_length);
+      buf.printf (", %d)", keyword->_allchars_length);
+    }
+  else
+    output_string (buf, keyword->_allchars, keyword->_allchars_length);
+}
+
+static void
+output_keyword_blank_entries (Output_Buffer& buf, int count)
+{
+  int columns;
+  if (option[TYPE])
+    {
+      columns = 58 / (4 + (option[NULLSTRINGS] ? 7 : 2)
+                        + strlen (option.get_initializer_suffix()));
+      if (columns == 0)
+        columns = 1;
+    }
+  else
+    columns = 9;
+
+  for (int i = 0; i < count; i++)
+    {
+      if ((i % columns) == 0)
+        {
+          if (i > 0)
+            buf.put (",\n");
+          buf.put ("      ");
+        }
+      else
+        buf.put (", ");
+      if (option[TYPE])
+        {
+          buf.put (option[NULLSTRINGS] ? "{nullptr" : "{\"\"");
+          buf.put (option.get_initializer_suffix());
+          buf.put ('}');
+        }
+      else
+        buf.put ("\"\"");
+    }
+}
+
+/* Prints out the array containing the keywords for the hash function,
+   and with -t the array of their lengths, which spares the lookup a
+   strlen() of the keyword.  */
+
+void
+OutputCxx::output_keyword_table () const
+{
+  Output_Buffer buf;
+  vector<int> lengths;
+  KeywordExt_List *temp;
+  int index;
+
+  if (option[TYPE])
+    printf ("  static constexpr %s %s[] =\n"
+            "    {\n",
+            _struct_tag, option.get_wordlist_name ());
+  else
+    printf ("  static constexpr std::string_view %s[] =\n"
+            "    {\n",
+            option.get_wordlist_name ());
+
+  if (option.is_mph_algo())
+    {
+      /* The MPH algorithms have no duplicates and no blank entries.
+         BPZ puts keyword I at hash value result_map[I], CHM at hash
+         value I.  */
+      struct nbperf *nbperf = option.nbperf ();
+      vector<KeywordExt *> keywords (nbperf->n);
+      index = 0;
+      for (temp = _head; temp; temp = temp->rest(), index++)
+        keywords[option[BPZ_ALGO] ? nbperf->result_map[index] : index]
+          = temp->first();
+      if (option[BPZ_ALGO])
+        free (nbperf->result_map);
+
+      for (index = 0; index < (int) keywords.size (); index++)
+        {
+          if (index > 0)
+            buf.put (",\n");
+          keywords[index]->_final_index = index;
+          output_keyword_entry (buf, keywords[index]);
+          lengths.push_back (keywords[index]->_allchars_length);
+          buf.flush_if_large (stdout);
+        }
+    }
+  else
+    {
+      for (temp = _head, index = 0; temp; temp = temp->rest())
+        {
+          KeywordExt *keyword = temp->first();
+
+          if (index > 0)
+            buf.put (",\n");
+
+          if (index < keyword->_hash_value)
+            {
+              /* Some blank entries.  */
+              output_keyword_blank_entries (buf, keyword->_hash_value - index);
+              buf.put (",\n");
+              lengths.resize (keyword->_hash_value, 0);
+              index = keyword->_hash_value;
+            }
+
+          keyword->_final_index = index;
+
+          output_keyword_entry (buf, keyword);
+          lengths.push_back (keyword->_allchars_length);
+
+          index++;
+          buf.flush_if_large (stdout);
+        }
+    }
+  if (index > 0)
+    buf.put ('\n');
+  buf.put ("    };\n");
+
+  if (option[TYPE])
+    {
+      buf.printf ("  static constexpr %s %s[] =\n"
+                  "    {",
+                  smallest_unsigned_type (_max_key_len),
+                  option.get_lengthtable_name ());
+      const int columns = 14;
+      const int field_width = _max_key_len >= 100 ? 3 : 2;
+      for (size_t i = 0; i < lengths.size (); i++)
+        {
+          if (i > 0)
+            buf.put (',');
+          if ((i % columns) == 0)
+            buf.put ("\n     ");
+          buf.put_decimal (lengths[i], field_width);
+          buf.flush_if_large (stdout);
+        }
+      buf.put ("\n"
+               "    };\n");
+    }
+  buf.write (stdout);
+}
+
+/* Outputs the tables, as members of the class.  */
+
+void
+OutputCxx::output_tables () const
+{
+  output_asso_values ();
+
+  /* The tables of the MPH algorithms.  */
+  _hash_tables.write (stdout);
+
+  if (option.get_function_name ())
+    output_keyword_table ();
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Generates C++ code for the hash function that returns the
+   proper encoding for each keyword.
+   The hash function has the signature
+     unsigned int <hash> (std::string_view str).
+   As with the other languages, MIN_WORD_LENGTH <= str.size () <=
+   MAX_WORD_LENGTH when it is called.  */
+
+void
+OutputCxx::output_hash_function () const
+{
+  printf ("%sconstexpr unsigned int\n"
+          "%s::%s (std::string_view str)%s\n"
+          "{\n",
+          _template_head, _class_scope, option.get_hash_name (), _noexcept);
+
+  if (option.is_mph_algo())
+    _hash_body.write (stdout);
+  else if (_key_positions.get_size() == 0)
+    {
+      /* Trivial case: No key positions at all.  */
+      printf ("  return %s;\n",
+              _hash_includes_len ? "str.size ()" : "0");
+    }
+  else
+    {
+      /* Iterate through the key positions.  Remember that Positions::sort()
+         has sorted them in decreasing order, with Positions::LASTCHAR coming
+         last.  */
+      PositionIterator iter = _key_positions.iterator(_max_key_len);
+      int key_pos;
+
+      /* Get the highest key position.  */
+      key_pos = iter.next ();
+
+      if (key_pos == Positions::LASTCHAR || key_pos < _min_key_len)
+        {
+          /* We can perform additional optimizations here:
+             Write it out as a single expression.  */
+          printf ("  return %s",
+                  _hash_includes_len ? "str.size () + " : "");
+
+          for (; key_pos != Positions::LASTCHAR; )
+            {
+              output_asso_values_ref (key_pos);
+              if ((key_pos = iter.next ()) != PositionIterator::EOS)
+                printf (" + ");
+              else
+                break;
+            }
+
+          if (key_pos == Positions::LASTCHAR)
+            output_asso_values_ref (Positions::LASTCHAR);
+
+          printf (";\n");
+        }
+      else
+        {
+          /* We've got to use the correct, but brute force, technique.  */
+          printf ("  unsigned int hval = %s;\n\n"
+                  "  switch (%s)\n"
+                  "    {\n"
+                  "      default:\n",
+                  _hash_includes_len ? "str.size ()" : "0",
+                  _hash_includes_len ? "hval" : "str.size ()");
+
+          while (key_pos != Positions::LASTCHAR && key_pos >= _max_key_len)
+            if ((key_pos = iter.next ()) == PositionIterator::EOS)
+              break;
+
+          if (key_pos != PositionIterator::EOS && key_pos != Positions::LASTCHAR)
+            {
+              int i = key_pos;
+              do
+                {
+                  if (i > key_pos)
+                    printf ("        [[fallthrough]];\n");
+                  for ( ; i > key_pos; i--)
+                    printf ("      case %d:\n", i);
+
+                  printf ("        hval += ");
+                  output_asso_values_ref (key_pos);
+                  printf (";\n");
+
+                  key_pos = iter.next ();
+                }
+              while (key_pos != PositionIterator::EOS && key_pos != Positions::LASTCHAR);
+
+              if (i >= _min_key_len)
+                printf ("        [[fallthrough]];\n");
+              for ( ; i >= _min_key_len; i--)
+                printf ("      case %d:\n", i);
+            }
+
+          printf ("        break;\n"
+                  "    }\n"
+                  "  return hval");
+          if (key_pos == Positions::LASTCHAR)
+            {
+              printf (" + ");
+              output_asso_values_ref (Positions::LASTCHAR);
+            }
+          printf (";\n");
+        }
+    }
+  printf ("}\n\n");
+}
+
+/* Generates C++ code for the find method of --class-template.  It compares
+   the keyword with memcmp, on the length of the string_view, and is
+   therefore not constexpr.  */
+
+void
+OutputCxx::output_find_function () const
+{
+  const char *prefix = option.get_constants_prefix ();
+  const char *wordlist = option.get_wordlist_name ();
+
+  printf ("%sinline std::size_t\n"
+          "%s::find (std::string_view str) noexcept\n"
+          "{\n"
+          "  if (str.size () <= %sMAX_WORD_LENGTH && str.size () >= %sMIN_WORD_LENGTH)\n"
+          "    {\n"
+          "      unsigned int key = %s (str);\n"
+          "\n",
+          _template_head, _class_scope,
+          prefix, prefix, option.get_hash_name ());
+
+  if (option.is_mph_algo())
+    printf ("      if (key < %sTOTAL_KEYWORDS)\n", prefix);
+  else
+    printf ("      if (key <= %sMAX_HASH_VALUE)\n", prefix);
+
+  if (option[TYPE])
+    printf ("        if (str.size () == %s[key]\n"
+            "            && std::memcmp (str.data (), %s[key].%s, str.size ()) == 0)\n"
+            "          return key;\n",
+            option.get_lengthtable_name (),
+            wordlist, option.get_slot_name ());
+  else
+    printf ("        if (str.size () == %s[key].size ()\n"
+            "            && std::memcmp (str.data (), %s[key].data (), str.size ()) == 0)\n"
+            "          return key;\n",
+            wordlist, wordlist);
+
+  printf ("    }\n"
+          "  return npos;\n"
+          "}\n"
+          "\n");
+}
+
+/* Generates C++ code for the lookup functions.  */
+
+void
+OutputCxx::output_lookup_function () const
+{
+  const char *prefix = option.get_constants_prefix ();
+  const char *wordlist = option.get_wordlist_name ();
+
+  printf ("%sconstexpr %s\n"
+          "%s::%s (std::string_view str)%s\n"
+          "{\n"
+          "  if (str.size () <= %sMAX_WORD_LENGTH && str.size () >= %sMIN_WORD_LENGTH)\n"
+          "    {\n"
+          "      unsigned int key = %s (str);\n"
+          "\n",
+          _template_head, _return_type,
+          _class_scope, option.get_function_name (), _noexcept,
+          prefix, prefix, option.get_hash_name ());
+
+  /* The hash values of the MPH algorithms are below TOTAL_KEYWORDS, but
+     an out of bounds access would make a constant expression invalid, so
+     check the bound anyway.  */
+  if (option.is_mph_algo())
+    printf ("      if (key < %sTOTAL_KEYWORDS)\n", prefix);
+  else
+    printf ("      if (key <= %sMAX_HASH_VALUE)\n", prefix);
+
+  if (option[TYPE])
+    printf ("        if (str.size () == %s[key]\n"
+            "            && str == std::string_view (%s[key].%s, %s[key]))\n"
+            "          return &%s[key];\n",
+            option.get_lengthtable_name (),
+            wordlist, option.get_slot_name (), option.get_lengthtable_name (),
+            wordlist);
+  else
+    printf ("        if (str == %s[key])\n"
+            "          return %s[key].data ();\n",
+            wordlist, wordlist);
+
+  printf ("    }\n"
+          "  return nullptr;\n"
+          "}\n"
+          "\n"
+          "%sconstexpr %s\n"
+          "%s::%s (const char *str, std::size_t len)%s\n"
+          "{\n"
+          "  return %s (std::string_view (str, len));\n"
+          "}\n",
+          _template_head, _return_type,
+          _class_scope, option.get_function_name (), _noexcept,
+          option.get_function_name ());
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Generates the hash function and the key word recognizer function
+   based upon the user's Options.  */
+
+void
+OutputCxx::output ()
+{
+  if (!option[CPLUSPLUS])
+    {
+      fprintf (stderr, "--constexpr is only valid with -L C++.\n");
+      exit (1);
+    }
+  if (option[DUP] || option[SWITCH] || option[SHAREDLIB]
+      || option[SPLITTABLE] || option[UPPERLOWER])
+    {
+      fprintf (stderr, "--constexpr may not be used with -D, -S, -P, --merged-string-pool, --split-table or --ignore-case.\n");
+      exit (1);
+    }
+
+  compute_min_max ();
+
+  if (option[TYPE])
+    {
+      /* The tables are constexpr, thus const.  */
+      char *return_type = new char[strlen (_struct_tag) + 9];
+      sprintf (return_type, "const %s *", _struct_tag);
+      _return_type = return_type;
+    }
+  else
+    _return_type = "const char *";
+
+  /* With --class-template, the functions are defined as members of the
+     template for any argument, and none of them throws.  */
+  if (option[CLASSTEMPLATE])
+    {
+      char *class_scope = new char[strlen (option.get_class_name ()) + 4];
+      sprintf (class_scope, "%s<T>", option.get_class_name ());
+      _class_scope = class_scope;
+      _template_head = "template <typename T>\n";
+      _noexcept = " noexcept";
+    }
+  else
+    {
+      _class_scope = option.get_class_name ();
+      _template_head = "";
+      _noexcept = "";
+    }
+
+  printf ("/* C++ code produced by gperf version %s */\n", version_string);
+  printf ("/* ");
+  option.print_options ();
+  printf (" */\n");
+  if (!option[POSITIONS] && !option.is_mph_algo())
+    {
+      printf ("/* Computed positions: -k'");
+      _key_positions.print();
+      printf ("' */\n");
+    }
+  printf ("\n");
+
+  output_charset_check ();
+
+  output_verbatim_declarations ();
+
+  if (option[TYPE] && !option[NOTYPE])
+    printf ("%s\n", _struct_decl);
+
+  printf ("#include <cstddef>\n");
+  if (option[CLASSTEMPLATE])
+    printf ("#include <cstring>\n");
+  printf ("#include <string_view>\n");
+  if (option.is_mph_algo())
+    printf ("#include <stdint.h>\n");
+  printf ("\n");
+
+  /* The hash function is private if there is a lookup function, the
+     tables unless -G is given.  */
+  const bool has_lookup = option.get_function_name () != NULL;
+  if (option[CLASSTEMPLATE])
+    printf ("template <typename = void>\n");
+  printf ("class %s\n"
+          "{\n"
+          "public:\n",
+          option.get_class_name ());
+  output_constants ();
+  if (option[CLASSTEMPLATE] && has_lookup)
+    printf ("  static constexpr std::size_t npos = static_cast<std::size_t>(-1);\n");
+  if (has_lookup)
+    output_function_declarations (false);
+  else
+    output_function_declarations (true);
+  if (option[GLOBAL])
+    output_tables ();
+  if (has_lookup || !option[GLOBAL])
+    printf ("private:\n");
+  if (has_lookup)
+    output_function_declarations (true);
+  if (!option[GLOBAL])
+    output_tables ();
+  printf ("};\n"
+          "\n");
+
+  output_hash_function ();
+
+  if (has_lookup)
+    {
+      if (option[CLASSTEMPLATE])
+        output_find_function ();
+      output_lookup_function ();
+    }
+
+  output_verbatim_code ();
+
+  fflush (stdout);
+}
@@ -0,0 +1,88 @@
+#ifndef output_cxx_h
+#define output_cxx_h 1
+
+#include "output.h"
+
+/* Output of C++17 code for --constexpr: a class whose tables are static
+   constexpr members and whose hash and lookup functions are constexpr and
+   take a std::string_view, so that lookups of constant strings are done
+   at compile time.  With --class-template, the class is a template, with
+   a find method that returns the index of the keyword.  */
+
+class OutputCxx : public Output
+{
+public:
+  /* Constructor. */
+  OutputCxx (KeywordExt_List *head,
+             const char *struct_decl,
+             unsigned int struct_decl_lineno,
+             const char *return_type,
+             const char *struct_tag,
+             const char *verbatim_declarations,
+             const char *verbatim_declarations_end,
+             unsigned int verbatim_declarations_lineno,
+             const char *verbatim_code,
+             const char *verbatim_code_end,
+             unsigned int verbatim_code_lineno,
+             bool charset_dependent,
+             int total_keys,
+             int max_key_len, int min_key_len,
+             bool hash_includes_len,
+             const Positions& positions,
+             const unsigned int *alpha_inc,
+             int total_duplicates,
+             unsigned int alpha_size,
+             const int *asso_values);
+
+  /* Generates the hash function and the key word recognizer function.  */
+  void output ();
+
+protected:
+
+  /* Outputs the maximum and minimum hash values etc., as members of the
+     class.  */
+  void                  output_constants () const;
+
+  /* Outputs the declarations of the hash function and of the lookup
+     functions.  */
+  void                  output_function_declarations (bool hash) const;
+
+  /* Outputs the asso_values array, as a member of the class.  */
+  void                  output_asso_values () const;
+
+  /* Generates a C++ expression for an asso_values[] reference.  */
+  void                  output_asso_values_ref (int pos) const;
+
+  /* Prints out the array containing the keywords for the hash function,
+     and, with -t, the array of their lengths, as members of the class.  */
+  void                  output_keyword_table () const;
+
+  /* Outputs the tables, as members of the class.  */
+  void                  output_tables () const;
+
+  /* Generates C++ code for the hash function that returns the
+     proper encoding for each keyword.  */
+  void                  output_hash_function () const;
+
+  /* Generates C++ code for the find method of --class-template.  */
+  void                  output_find_function () const;
+
+  /* Generates C++ code for the lookup functions.  */
+  void                  output_lookup_function () const;
+
+private:
+
+  /* The scope of the member function definitions: the class name, or
+     with --class-template the class name with the template argument.  */
+  const char *          _class_scope;
+
+  /* With --class-template, the template head of the member function
+     definitions, otherwise empty.  */
+  const char *          _template_head;
+
+  /* With --class-template, the exception specification of the functions,
+     otherwise empty.  */
+  const char *          _noexcept;
+};
+
+#endif
@@ -6,8 +6,13 @@
 #include <assert.h> /* defines assert() */
 #include <ctype.h>  /* declares isprint() */
 #include <stdio.h>
+#include <stdlib.h> /* declares free() */
+#include <vector>
 #include "options.h"
 #include "version.h"
+#include "nbperf.h"
+
+using std::vector;
 
 OutputJavascript::OutputJavascript (KeywordExt_List *head,
                                     const char *struct_decl,
@@ -45,36 +50,18 @@ OutputJavascript::output_constants (const char *indent) const
 {
   const char *prefix = option.get_constants_prefix ();
 
-  if (option[GLOBAL])
-    {
-      printf (
-          "%s%sTOTAL_KEYWORDS:  %d,\n"
-          "%s%sMIN_WORD_LENGTH: %d,\n"
-          "%s%sMAX_WORD_LENGTH: %d,\n"
-          "%s%sMIN_HASH_VALUE:  %d,\n"
-          "%s%sMAX_HASH_VALUE:  %d,\n"
-          "\n",
-          indent, prefix, _total_keys,
-          indent, prefix, _min_key_len,
-          indent, prefix, _max_key_len,
-          indent, prefix, _min_hash_value,
-          indent, prefix, _max_hash_value);
-    }
-  else
-    {
-      printf (
-          "%svar %sTOTAL_KEYWORDS  = %d,\n"
-          "%svar %sMIN_WORD_LENGTH = %d,\n"
-          "%svar %sMAX_WORD_LENGTH = %d,\n"
-          "%svar %sMIN_HASH_VALUE  = %d,\n"
-          "%svar %sMAX_HASH_VALUE  = %d,\n"
-          "\n",
-          indent, prefix, _total_keys,
-          indent, prefix, _min_key_len,
-          indent, prefix, _max_key_len,
-          indent, prefix, _min_hash_value,
-          indent, prefix, _max_hash_value);
-    }
+  printf (
+      "%svar %sTOTAL_KEYWORDS  = %d,\n"
+      "%s    %sMIN_WORD_LENGTH = %d,\n"
+      "%s    %sMAX_WORD_LENGTH = %d,\n"
+      "%s    %sMIN_HASH_VALUE  = %d,\n"
+      "%s    %sMAX_HASH_VALUE  = %d;\n"
+      "\n",
+      indent, prefix, _total_keys,
+      indent, prefix, _min_key_len,
+      indent, prefix, _max_key_len,
+      indent, prefix, _min_hash_value,
+      indent, prefix, _max_hash_value);
 }
 
 /* ------------------------------------------------------------------------- */
@@ -98,16 +85,34 @@ OutputJavascript::output_asso_values_ref (int pos) const
   printf ("]");
 }
 
-void
-OutputJavascript::output_hash_function () const
+/* Returns the name of the smallest typed array type that holds all the
+   values 0 ... MAX_VALUE.  */
+
+static const char *
+typed_array_type (int max_value)
 {
-  printf ("  %s: function (str) {\n", option.get_hash_name ());
-  printf ("    \"use strict\";\n");
+  if (max_value < 256)
+    return "Uint8Array";
+  if (max_value < 65536)
+    return "Uint16Array";
+  return "Int32Array";
+}
+
+/* Outputs the asso_values array, as a typed array that is built once when
+   the module is loaded.  */
 
-  /* First the asso_values array.  */
-  if (_key_positions.get_size() > 0)
+void
+OutputJavascript::output_asso_values () const
+{
+  if (!option.is_mph_algo() && _key_positions.get_size() > 0)
     {
-      printf ("    var asso_values = [");
+      int max_value = 0;
+      for (unsigned int count = 0; count < _alpha_size; count++)
+        if (_asso_values[count] > max_value)
+          max_value = _asso_values[count];
+
+      printf ("  var asso_values = new %s([",
+              typed_array_type (max_value));
 
       const int columns = 10;
 
@@ -116,17 +121,48 @@ OutputJavascript::output_hash_function () const
       for (int trunc = _max_hash_value; (trunc /= 10) > 0;)
         field_width++;
 
+      Output_Buffer buf;
       for (unsigned int count = 0; count < _alpha_size; count++)
         {
           if (count > 0)
-            printf (",");
+            buf.put (',');
           if ((count % columns) == 0)
-            printf ("\n     ");
-          printf ("%*d", field_width, _asso_values[count]);
+            buf.put ("\n   ");
+          buf.put_decimal (_asso_values[count], field_width);
+          buf.flush_if_large (stdout);
         }
+      buf.write (stdout);
 
       printf ("\n"
-              "    ];\n");
+              "  ]);\n\n");
+    }
+}
+
+void
+OutputJavascript::output_hash_function () const
+{
+  printf ("  function %s (str) {\n", option.get_hash_name ());
+
+  if (option.is_mph_algo())
+    {
+      /* The MPH generators indent the body with tabs, as for C.  */
+      Output_Buffer buf;
+      const char *body = _hash_body.data ();
+      size_t size = _hash_body.size ();
+      bool line_start = true;
+      for (size_t i = 0; i < size; i++)
+        {
+          if (line_start && body[i] == '\t')
+            buf.put ("    ");
+          else
+            {
+              buf.put (body[i]);
+              line_start = (body[i] == '\n');
+            }
+        }
+      buf.write (stdout);
+      printf ("  }\n");
+      return;
     }
 
   if (_key_positions.get_size() == 0)
@@ -200,7 +236,7 @@ OutputJavascript::output_hash_function () const
                   for ( ; i > key_pos; i--)
                     ;
 
-                  printf ("    if (hval >= %d) {\n", key_pos + 1);
+                  printf ("    if (str.length >= %d) {\n", key_pos + 1);
                   printf ("      hval += ");
                   output_asso_values_ref (key_pos);
                   printf (";\n");
@@ -221,10 +257,7 @@ OutputJavascript::output_hash_function () const
         }
     }
 
-  if (option[NOLOOKUPFUNC])
-    printf ("  }\n");
-  else
-    printf ("  },\n");
+  printf ("  }\n");
 }
 
 /* ------------------------------------------------------------------------- */
@@ -233,47 +266,58 @@ OutputJavascript::output_hash_function () const
    backslashes, double quote and unprintable characters.  */
 
 static void
-output_string (const char *key, int len)
+output_string (Output_Buffer& buf, const char *key, int len)
 {
-  putchar ('"');
+  buf.put ('"');
   for (; len > 0; len--)
     {
       unsigned char c = static_cast<unsigned char>(*key++);
       if (isprint (c))
         {
           if (c == '"' || c == '\\')
-            putchar ('\\');
-          putchar (c);
+            buf.put ('\\');
+          buf.put (c);
         }
       else
         {
-          /* Use octal escapes, not hexadecimal escapes, because some old
-             C compilers didn't understand hexadecimal escapes, and because
-             hexadecimal escapes are not limited to 2 digits, thus needing
-             special care if the following character happens to be a digit.  */
-          putchar ('\\');
-          putchar ('0' + ((c >> 6) & 7));
-          putchar ('0' + ((c >> 3) & 7));
-          putchar ('0' + (c & 7));
+          /* Use hexadecimal escapes, not octal escapes, because octal
+             escapes are a syntax error in strict mode code.  In JavaScript,
+             a hexadecimal escape has exactly 2 digits.  */
+          static const char hex[] = "0123456789abcdef";
+          char escape[4];
+          escape[0] = '\\';
+          escape[1] = 'x';
+          escape[2] = hex[c >> 4];
+          escape[3] = hex[c & 15];
+          buf.put (escape, 4);
         }
     }
-  putchar ('"');
+  buf.put ('"');
+}
+
+static void
+output_string (const char *key, int len)
+{
+  Output_Buffer buf;
+  output_string (buf, key, len);
+  buf.write (stdout);
 }
 
 /* ------------------------------------------------------------------------- */
 
 static void
-output_keyword_entry (KeywordExt *temp, int stringpool_index, const char *indent)
+output_keyword_entry (Output_Buffer& buf, KeywordExt *temp, int stringpool_index, const char *indent)
 {
-  printf ("%s  ", indent);
-  output_string (temp->_allchars, temp->_allchars_length);
+  buf.put (indent);
+  buf.put ("  ");
+  output_string (buf, temp->_allchars, temp->_allchars_length);
   if (option[DEBUG])
-    printf (" /* hash value = %d, index = %d */",
-            temp->_hash_value, temp->_final_index);
+    buf.printf (" /* hash value = %d, index = %d */",
+                temp->_hash_value, temp->_final_index);
 }
 
 static void
-output_keyword_blank_entries (int count, const char *indent)
+output_keyword_blank_entries (Output_Buffer& buf, int count, const char *indent)
 {
   int columns;
   columns = (option[NULLSTRINGS] ? 4 : 9);
@@ -284,18 +328,17 @@ output_keyword_blank_entries (int count, const char *indent)
       if ((column % columns) == 0)
         {
           if (i > 0)
-            printf (",\n");
-          printf ("%s  ", indent);
+            buf.put (",\n");
+          buf.put (indent);
+          buf.put ("  ");
         }
       else
         {
           if (i > 0)
-            printf (", ");
+            buf.put (", ");
         }
-      if (option[NULLSTRINGS])
-        printf ("");
-      else
-        printf ("\"\"");
+      if (!option[NULLSTRINGS])
+        buf.put ("\"\"");
       column++;
     }
 }
@@ -305,53 +348,75 @@ output_keyword_blank_entries (int count, const char *indent)
 void
 OutputJavascript::output_keyword_table () const
 {
-  const char *indent  = option[GLOBAL] ? "  " : "    ";
+  const char *indent  = "  ";
+  Output_Buffer buf;
   int index;
   KeywordExt_List *temp;
 
-  if (option[GLOBAL])
-    printf ("\n%s%s: [\n",
-            indent, option.get_wordlist_name ());
-  else
-    printf ("%svar %s = [\n",
-            indent, option.get_wordlist_name ());
+  printf ("%svar %s = [\n",
+          indent, option.get_wordlist_name ());
 
   /* Generate an array of reserved words at appropriate locations.  */
 
-  for (temp = _head, index = 0; temp; temp = temp->rest())
+  if (option.is_mph_algo())
+    {
+      /* The MPH algorithms have no duplicates and no blank entries.
+         BPZ puts keyword I at hash value result_map[I], CHM at hash
+         value I.  */
+      struct nbperf *nbperf = option.nbperf ();
+      vector<KeywordExt *> keywords (nbperf->n);
+      index = 0;
+      for (temp = _head; temp; temp = temp->rest(), index++)
+        keywords[option[BPZ_ALGO] ? nbperf->result_map[index] : index]
+          = temp->first();
+      if (option[BPZ_ALGO])
+        free (nbperf->result_map);
+
+      for (index = 0; index < (int) keywords.size (); index++)
+        {
+          if (index > 0)
+            buf.put (",\n");
+          keywords[index]->_final_index = index;
+          output_keyword_entry (buf, keywords[index], index, indent);
+          buf.flush_if_large (stdout);
+        }
+    }
+  else
     {
-      KeywordExt *keyword = temp->first();
+      for (temp = _head, index = 0; temp; temp = temp->rest())
+        {
+          KeywordExt *keyword = temp->first();
 
-      /* If generating a switch statement, and there is no user defined type,
-         we generate non-duplicates directly in the code.  Only duplicates go
-         into the table.  */
-      if (option[SWITCH] && !keyword->_duplicate_link)
-        continue;
+          /* If generating a switch statement, and there is no user defined type,
+             we generate non-duplicates directly in the code.  Only duplicates go
+             into the table.  */
+          if (option[SWITCH] && !keyword->_duplicate_link)
+            continue;
 
-      if (index > 0)
-        printf (",\n");
+          if (index > 0)
+            buf.put (",\n");
 
-      if (index < keyword->_hash_value && !option[SWITCH])
-        {
-          /* Some blank entries.  */
-          output_keyword_blank_entries (keyword->_hash_value - index, indent);
-          printf (",\n");
-          index = keyword->_hash_value;
-        }
+          if (index < keyword->_hash_value && !option[SWITCH])
+            {
+              /* Some blank entries.  */
+              output_keyword_blank_entries (buf, keyword->_hash_value - index, indent);
+              buf.put (",\n");
+              index = keyword->_hash_value;
+            }
 
-      keyword->_final_index = index;
+          keyword->_final_index = index;
 
-      output_keyword_entry (keyword, index, indent);
+          output_keyword_entry (buf, keyword, index, indent);
 
-      index++;
+          index++;
+          buf.flush_if_large (stdout);
+        }
     }
   if (index > 0)
-    printf ("\n");
+    buf.put ('\n');
 
-  if (option[GLOBAL])
-    printf ("%s],\n", indent);
-  else
-    printf ("%s];\n", indent);
+  buf.printf ("%s];\n\n", indent);
+  buf.write (stdout);
 }
 
 /* Generate all the tables needed for the lookup function.  */
@@ -520,23 +585,46 @@ OutputJavascript::output_lookup_function_body () const
 void
 OutputJavascript::output_lookup_function () const
 {
-  printf ("\n  %s: function (str) {\n", option.get_function_name ());
-  printf ("    \"use strict\";\n");
-
-  if (!option[GLOBAL])
-      output_constants ("    ");
-
-  if (!option[GLOBAL])
-    {
-      output_lookup_tables ();
-      printf ("\n");
-    }
+  printf ("\n  function %s (str) {\n", option.get_function_name ());
 
   output_lookup_function_body ();
 
   printf ("  }\n");
 }
 
+/* Outputs the object that exports the functions, and with -G also the
+   constants and tables.  */
+
+void
+OutputJavascript::output_exports () const
+{
+  const char *prefix = option.get_constants_prefix ();
+
+  printf ("\n  return {\n");
+  if (option[GLOBAL])
+    {
+      printf ("    %sTOTAL_KEYWORDS: %sTOTAL_KEYWORDS,\n"
+              "    %sMIN_WORD_LENGTH: %sMIN_WORD_LENGTH,\n"
+              "    %sMAX_WORD_LENGTH: %sMAX_WORD_LENGTH,\n"
+              "    %sMIN_HASH_VALUE: %sMIN_HASH_VALUE,\n"
+              "    %sMAX_HASH_VALUE: %sMAX_HASH_VALUE,\n",
+              prefix, prefix, prefix, prefix, prefix, prefix,
+              prefix, prefix, prefix, prefix);
+      if (!option.is_mph_algo() && _key_positions.get_size() > 0)
+        printf ("    asso_values: asso_values,\n");
+      if (!option[NOLOOKUPFUNC] && !option[SWITCH])
+        printf ("    %s: %s,\n",
+                option.get_wordlist_name (), option.get_wordlist_name ());
+    }
+  printf ("    %s: %s", option.get_hash_name (), option.get_hash_name ());
+  if (!option[NOLOOKUPFUNC])
+    printf (",\n"
+            "    %s: %s",
+            option.get_function_name (), option.get_function_name ());
+  printf ("\n"
+          "  };\n");
+}
+
 void
 OutputJavascript::output ()
 {
@@ -549,7 +637,7 @@ OutputJavascript::output ()
   printf ("/* ");
   option.print_options ();
   printf (" */\n");
-  if (!option[POSITIONS])
+  if (!option[POSITIONS] && !option.is_mph_algo())
     {
       printf ("/* Computed positions: -k'");
       _key_positions.print();
@@ -557,21 +645,31 @@ OutputJavascript::output ()
     }
   printf ("\n");
 
-  printf ("%s = {\n", option.get_class_name ());
+  /* The tables are built once, when the module is loaded, and the functions
+     reach them through the closure.  */
+  printf ("var %s = (function () {\n"
+          "  \"use strict\";\n"
+          "\n",
+          option.get_class_name ());
 
-  if (option[GLOBAL])
-    output_constants ("  ");
+  output_constants ("  ");
 
-  output_hash_function ();
+  output_asso_values ();
 
-  if (!option[NOLOOKUPFUNC]) {
-    if (option[GLOBAL])
-      output_lookup_tables ();
+  /* The tables of the MPH algorithms.  */
+  _hash_tables.write (stdout);
 
+  if (!option[NOLOOKUPFUNC])
+    output_lookup_tables ();
+
+  output_hash_function ();
+
+  if (!option[NOLOOKUPFUNC])
     output_lookup_function ();
-  }
 
-  printf ("};\n");
+  output_exports ();
+
+  printf ("})();\n");
 
   fflush (stdout);
 }
@@ -39,6 +39,9 @@ protected:
   /* Generates a JavaScript expression for an asso_values[] reference.  */
   void                  output_asso_values_ref (int pos) const;
 
+  /* Outputs the asso_values array.  */
+  void                  output_asso_values () const;
+
   /* Generates JavaScript code for the hash function that returns the
      proper encoding for each keyword.  */
   void                  output_hash_function () const;
@@ -54,6 +57,9 @@ protected:
 
   /* Generates JavaScript code for the lookup function.  */
   void                  output_lookup_function () const;
+
+  /* Outputs the object returned by the module.  */
+  void                  output_exports () const;
 };
 
 #endif
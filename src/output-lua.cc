@@ -6,8 +6,13 @@
 #include <assert.h> /* defines assert() */
 #include <ctype.h>  /* declares isprint() */
 #include <stdio.h>
+#include <stdlib.h> /* declares free() */
+#include <vector>
 #include "options.h"
 #include "version.h"
+#include "nbperf.h"
+
+using std::vector;
 
 OutputLua::OutputLua (KeywordExt_List *head,
                       const char *struct_decl,
@@ -45,69 +50,30 @@ OutputLua::output_constants (const char *indent) const
 {
   const char *prefix = option.get_constants_prefix ();
 
-  if (option[GLOBAL])
-    {
-      printf (
-          "\n"
-          "%s%s.%sTOTAL_KEYWORDS  = %d\n"
-          "%s%s.%sMIN_WORD_LENGTH = %d\n"
-          "%s%s.%sMAX_WORD_LENGTH = %d\n"
-          "%s%s.%sMIN_HASH_VALUE  = %d\n"
-          "%s%s.%sMAX_HASH_VALUE  = %d\n",
-          indent, option.get_class_name (), prefix, _total_keys,
-          indent, option.get_class_name (), prefix, _min_key_len,
-          indent, option.get_class_name (), prefix, _max_key_len,
-          indent, option.get_class_name (), prefix, _min_hash_value,
-          indent, option.get_class_name (), prefix, _max_hash_value);
-    }
-  else
-    {
-      printf (
-          "%slocal %sTOTAL_KEYWORDS  = %d\n"
-          "%slocal %sMIN_WORD_LENGTH = %d\n"
-          "%slocal %sMAX_WORD_LENGTH = %d\n"
-          "%slocal %sMIN_HASH_VALUE  = %d\n"
-          "%slocal %sMAX_HASH_VALUE  = %d\n"
-          "\n",
-          indent, prefix, _total_keys,
-          indent, prefix, _min_key_len,
-          indent, prefix, _max_key_len,
-          indent, prefix, _min_hash_value,
-          indent, prefix, _max_hash_value);
-    }
+  printf (
+      "%slocal %sTOTAL_KEYWORDS  = %d\n"
+      "%slocal %sMIN_WORD_LENGTH = %d\n"
+      "%slocal %sMAX_WORD_LENGTH = %d\n"
+      "%slocal %sMIN_HASH_VALUE  = %d\n"
+      "%slocal %sMAX_HASH_VALUE  = %d\n"
+      "\n",
+      indent, prefix, _total_keys,
+      indent, prefix, _min_key_len,
+      indent, prefix, _max_key_len,
+      indent, prefix, _min_hash_value,
+      indent, prefix, _max_hash_value);
 }
 
 /* ------------------------------------------------------------------------- */
 
-/* Generates a Lua expression for an asso_values[] reference.  */
+/* Outputs the asso_values table.  */
 
 void
-OutputLua::output_asso_values_ref (int pos) const
+OutputLua::output_asso_values () const
 {
-  printf ("asso_values[");
-  /* Always cast to unsigned char.  This is necessary when the alpha_inc
-     is nonzero, and also avoids a gcc warning "subscript has type 'char'".  */
-  if (pos == Positions::LASTCHAR)
-    printf ("str:byte(-1)");
-  else
+  if (!option.is_mph_algo() && _key_positions.get_size() > 0)
     {
-      printf ("str:byte(%d + 1)", pos);
-      if (_alpha_inc[pos])
-        printf ("+%u", _alpha_inc[pos]);
-    }
-  printf (" + 1]");
-}
-
-void
-OutputLua::output_hash_function () const
-{
-  printf ("\nfunction %s.%s(str)\n",
-      option.get_class_name (), option.get_hash_name ());
-
-  /* First the asso_values array.  */
-  if (_key_positions.get_size() > 0)
-    {
-      printf ("    local asso_values = {");
+      printf ("local asso_values = {");
 
       const int columns = 10;
 
@@ -116,112 +82,185 @@ OutputLua::output_hash_function () const
       for (int trunc = _max_hash_value; (trunc /= 10) > 0;)
         field_width++;
 
+      Output_Buffer buf;
       for (unsigned int count = 0; count < _alpha_size; count++)
         {
           if (count > 0)
-            printf (",");
+            buf.put (',');
           if ((count % columns) == 0)
-            printf ("\n       ");
-          printf ("%*d", field_width, _asso_values[count]);
+            buf.put ("\n   ");
+          buf.put_decimal (_asso_values[count], field_width);
+          buf.flush_if_large (stdout);
         }
+      buf.write (stdout);
 
       printf ("\n"
-              "    }\n");
+              "}\n\n");
     }
+}
 
-  if (_key_positions.get_size() == 0)
+/* Generates a Lua expression for an asso_values[] reference.  CHAR is the
+   expression for the byte at position POS.  */
+
+void
+OutputLua::output_asso_values_ref (int pos, const char *character) const
+{
+  /* Lua tables start at index 1.  */
+  unsigned int inc = 1;
+  if (pos != Positions::LASTCHAR)
+    inc += _alpha_inc[pos];
+  printf ("asso_values[%s + %u]", character, inc);
+}
+
+/* Largest number of unused bytes that a single string.byte call may fetch
+   between two key positions.  */
+#define MAX_BYTE_GAP 3
+
+/* Generates Lua code for the hash function that returns the
+   proper encoding for each keyword.  */
+
+void
+OutputLua::output_hash_function () const
+{
+  printf ("local function %s(str)\n", option.get_hash_name ());
+
+  if (option.is_mph_algo())
     {
-      /* Trivial case: No key positions at all.  */
-      printf ("    return %s\n",
-              _hash_includes_len ? "str:len()" : "0");
+      /* The MPH generators indent the body with tabs, as for C.  */
+      Output_Buffer buf;
+      const char *body = _hash_body.data ();
+      size_t size = _hash_body.size ();
+      bool line_start = true;
+      for (size_t i = 0; i < size; i++)
+        {
+          if (line_start && body[i] == '\t')
+            buf.put ("    ");
+          else
+            {
+              buf.put (body[i]);
+              line_start = (body[i] == '\n');
+            }
+        }
+      buf.write (stdout);
+      printf ("end\n"
+              "%s.%s = %s\n",
+              option.get_class_name (), option.get_hash_name (),
+              option.get_hash_name ());
+      return;
     }
-  else
+
+  /* The key positions below _min_key_len exist in every keyword and are
+     fetched together, with one string.byte call per group of close
+     positions.  The others need a length check.  Positions::sort() has
+     sorted the positions in decreasing order, with Positions::LASTCHAR
+     coming last.  */
+  int num_positions = _key_positions.get_size();
+  bool has_lastchar = false;
+  int num_unguarded = 0;
+  int num_guarded = 0;
+  for (int i = 0; i < num_positions; i++)
     {
-      /* Iterate through the key positions.  Remember that Positions::sort()
-         has sorted them in decreasing order, with Positions::LASTCHAR coming
-         last.  */
-      PositionIterator iter = _key_positions.iterator(_max_key_len);
-      int key_pos;
+      int pos = _key_positions[i];
+      if (pos == Positions::LASTCHAR)
+        has_lastchar = true;
+      else if (pos < _min_key_len)
+        num_unguarded++;
+      else if (pos < _max_key_len)
+        num_guarded++;
+    }
 
-      /* Get the highest key position.  */
-      key_pos = iter.next ();
+  if (_hash_includes_len || num_guarded > 0)
+    printf ("    local len = #str\n");
 
-      if (key_pos == Positions::LASTCHAR || key_pos < _min_key_len)
+  /* The unguarded positions, in increasing order.  */
+  for (int i = num_positions - (has_lastchar ? 1 : 0) - 1;
+       i >= num_positions - (has_lastchar ? 1 : 0) - num_unguarded; )
+    {
+      int first = _key_positions[i];
+      int last = first;
+      int j = i - 1;
+      while (j >= num_positions - (has_lastchar ? 1 : 0) - num_unguarded
+             && _key_positions[j] - last <= MAX_BYTE_GAP + 1)
+        last = _key_positions[j--];
+
+      printf ("    local ");
+      for (int pos = first, k = i; pos <= last; pos++)
         {
-          /* We can perform additional optimizations here:
-             Write it out as a single expression. Note that the values
-             are added as 'int's even though the asso_values array may
-             contain 'unsigned char's or 'unsigned short's.  */
-
-          printf ("    return %s",
-                  _hash_includes_len ? "str:len() + " : "");
-
-          if (_key_positions.get_size() == 2
-              && _key_positions[0] == 0
-              && _key_positions[1] == Positions::LASTCHAR)
-            /* Optimize special case of "-k 1,$".  */
+          if (pos > first)
+            printf (", ");
+          if (pos == _key_positions[k])
             {
-              output_asso_values_ref (Positions::LASTCHAR);
-              printf (" + ");
-              output_asso_values_ref (0);
+              printf ("c%d", pos + 1);
+              k--;
             }
           else
-            {
-              for (; key_pos != Positions::LASTCHAR; )
-                {
-                  output_asso_values_ref (key_pos);
-                  if ((key_pos = iter.next ()) != PositionIterator::EOS)
-                    printf (" + ");
-                  else
-                    break;
-                }
-
-              if (key_pos == Positions::LASTCHAR)
-                output_asso_values_ref (Positions::LASTCHAR);
-            }
-
-          printf ("\n");
+            printf ("_");
         }
+      if (first == last)
+        printf (" = byte(str, %d)\n", first + 1);
       else
-        {
-          /* We've got to use the correct, but brute force, technique.  */
-          printf ("    local hval = %s\n\n",
-                  _hash_includes_len ? "str:len()" : "0");
-
-          while (key_pos != Positions::LASTCHAR && key_pos >= _max_key_len)
-            if ((key_pos = iter.next ()) == PositionIterator::EOS)
-              break;
+        printf (" = byte(str, %d, %d)\n", first + 1, last + 1);
+      i = j;
+    }
 
-          if (key_pos != PositionIterator::EOS && key_pos != Positions::LASTCHAR)
-            {
-              int i = key_pos;
-              do
-                {
-                  for ( ; i > key_pos; i--)
-                    ;
-
-                  printf ("    if (hval >= %d) then\n", key_pos + 1);
-                  printf ("        hval = hval + ");
-                  output_asso_values_ref (key_pos);
-                  printf ("\n");
-                  printf ("    end\n");
-
-                  key_pos = iter.next ();
-                }
-              while (key_pos != PositionIterator::EOS && key_pos != Positions::LASTCHAR);
-            }
+  const char *sum_start = num_guarded > 0 ? "    local hval = " : "    return ";
+  if (num_unguarded == 0 && !has_lastchar)
+    printf ("%s%s\n", sum_start, _hash_includes_len ? "len" : "0");
+  else
+    {
+      printf ("%s%s", sum_start, _hash_includes_len ? "len + " : "");
+      bool first_term = true;
+      for (int i = 0; i < num_positions; i++)
+        {
+          int pos = _key_positions[i];
+          if (pos == Positions::LASTCHAR || pos >= _min_key_len)
+            continue;
+          if (!first_term)
+            printf (" + ");
+          char character[16];
+          snprintf (character, sizeof (character), "c%d", pos + 1);
+          output_asso_values_ref (pos, character);
+          first_term = false;
+        }
+      if (has_lastchar && num_guarded == 0)
+        {
+          if (!first_term)
+            printf (" + ");
+          output_asso_values_ref (Positions::LASTCHAR, "byte(str, -1)");
+        }
+      printf ("\n");
+    }
 
-          printf ("    return hval");
-          if (key_pos == Positions::LASTCHAR)
-            {
-              printf (" + ");
-              output_asso_values_ref (Positions::LASTCHAR);
-            }
-          printf ("\n");
+  if (num_guarded > 0)
+    {
+      for (int i = 0; i < num_positions; i++)
+        {
+          int pos = _key_positions[i];
+          if (pos == Positions::LASTCHAR
+              || pos < _min_key_len || pos >= _max_key_len)
+            continue;
+          char character[32];
+          snprintf (character, sizeof (character), "byte(str, %d)", pos + 1);
+          printf ("    if len >= %d then\n"
+                  "        hval = hval + ",
+                  pos + 1);
+          output_asso_values_ref (pos, character);
+          printf ("\n"
+                  "    end\n");
+        }
+      printf ("    return hval");
+      if (has_lastchar)
+        {
+          printf (" + ");
+          output_asso_values_ref (Positions::LASTCHAR, "byte(str, -1)");
         }
+      printf ("\n");
     }
 
-  printf ("end\n");
+  printf ("end\n"
+          "%s.%s = %s\n",
+          option.get_class_name (), option.get_hash_name (),
+          option.get_hash_name ());
 }
 
 /* ------------------------------------------------------------------------- */
@@ -230,47 +269,48 @@ OutputLua::output_hash_function () const
    backslashes, double quote and unprintable characters.  */
 
 static void
-output_string (const char *key, int len)
+output_string (Output_Buffer& buf, const char *key, int len)
 {
-  putchar ('"');
+  buf.put ('"');
   for (; len > 0; len--)
     {
       unsigned char c = static_cast<unsigned char>(*key++);
       if (isprint (c))
         {
           if (c == '"' || c == '\\')
-            putchar ('\\');
-          putchar (c);
+            buf.put ('\\');
+          buf.put (c);
         }
       else
         {
-          /* Use octal escapes, not hexadecimal escapes, because some old
-             C compilers didn't understand hexadecimal escapes, and because
-             hexadecimal escapes are not limited to 2 digits, thus needing
-             special care if the following character happens to be a digit.  */
-          putchar ('\\');
-          putchar ('0' + ((c >> 6) & 7));
-          putchar ('0' + ((c >> 3) & 7));
-          putchar ('0' + (c & 7));
+          /* Lua escapes are decimal, not octal.  Use all 3 digits, in case
+             the following character happens to be a digit.  */
+          char escape[4];
+          escape[0] = '\\';
+          escape[1] = '0' + c / 100;
+          escape[2] = '0' + c / 10 % 10;
+          escape[3] = '0' + c % 10;
+          buf.put (escape, 4);
         }
     }
-  putchar ('"');
+  buf.put ('"');
 }
 
 /* ------------------------------------------------------------------------- */
 
 static void
-output_keyword_entry (KeywordExt *temp, int stringpool_index, const char *indent)
+output_keyword_entry (Output_Buffer& buf, KeywordExt *temp, int stringpool_index, const char *indent)
 {
-  printf ("%s    ", indent);
-  output_string (temp->_allchars, temp->_allchars_length);
+  buf.put (indent);
+  buf.put ("    ");
+  output_string (buf, temp->_allchars, temp->_allchars_length);
   if (option[DEBUG])
-    printf (" -- hash value = %d, index = %d",
-            temp->_hash_value, temp->_final_index);
+    buf.printf (" -- hash value = %d, index = %d",
+                temp->_hash_value, temp->_final_index);
 }
 
 static void
-output_keyword_blank_entries (int count, const char *indent)
+output_keyword_blank_entries (Output_Buffer& buf, int count, const char *indent)
 {
   int columns;
   columns = (option[NULLSTRINGS] ? 4 : 9);
@@ -281,18 +321,19 @@ output_keyword_blank_entries (int count, const char *indent)
       if ((column % columns) == 0)
         {
           if (i > 0)
-            printf (",\n");
-          printf ("%s    ", indent);
+            buf.put (",\n");
+          buf.put (indent);
+          buf.put ("    ");
         }
       else
         {
           if (i > 0)
-            printf (", ");
+            buf.put (", ");
         }
       if (option[NULLSTRINGS])
-        printf ("nil");
+        buf.put ("nil");
       else
-        printf ("\"\"");
+        buf.put ("\"\"");
       column++;
     }
 }
@@ -302,44 +343,69 @@ output_keyword_blank_entries (int count, const char *indent)
 void
 OutputLua::output_keyword_table () const
 {
-  const char *indent  = option[GLOBAL] ? "" : "    ";
+  const char *indent  = "";
+  Output_Buffer buf;
   int index;
   KeywordExt_List *temp;
 
-  if (option[GLOBAL])
-    printf ("\n%s%s.%s = {\n",
-            indent, option.get_class_name (), option.get_wordlist_name ());
-  else
-    printf ("%slocal %s = {\n",
-            indent, option.get_wordlist_name ());
+  printf ("%slocal %s = {\n",
+          indent, option.get_wordlist_name ());
 
   /* Generate an array of reserved words at appropriate locations.  */
 
-  for (temp = _head, index = 0; temp; temp = temp->rest())
+  if (option.is_mph_algo())
     {
-      KeywordExt *keyword = temp->first();
-
-      if (index > 0)
-        printf (",\n");
-
-      if (index < keyword->_hash_value)
+      /* The MPH algorithms have no duplicates and no blank entries.
+         BPZ puts keyword I at hash value result_map[I], CHM at hash
+         value I.  */
+      struct nbperf *nbperf = option.nbperf ();
+      vector<KeywordExt *> keywords (nbperf->n);
+      index = 0;
+      for (temp = _head; temp; temp = temp->rest(), index++)
+        keywords[option[BPZ_ALGO] ? nbperf->result_map[index] : index]
+          = temp->first();
+      if (option[BPZ_ALGO])
+        free (nbperf->result_map);
+
+      for (index = 0; index < (int) keywords.size (); index++)
         {
-          /* Some blank entries.  */
-          output_keyword_blank_entries (keyword->_hash_value - index, indent);
-          printf (",\n");
-          index = keyword->_hash_value;
+          if (index > 0)
+            buf.put (",\n");
+          keywords[index]->_final_index = index;
+          output_keyword_entry (buf, keywords[index], index, indent);
+          buf.flush_if_large (stdout);
         }
+    }
+  else
+    {
+      for (temp = _head, index = 0; temp; temp = temp->rest())
+        {
+          KeywordExt *keyword = temp->first();
 
-      keyword->_final_index = index;
+          if (index > 0)
+            buf.put (",\n");
+
+          if (index < keyword->_hash_value)
+            {
+              /* Some blank entries.  */
+              output_keyword_blank_entries (buf, keyword->_hash_value - index, indent);
+              buf.put (",\n");
+              index = keyword->_hash_value;
+            }
 
-      output_keyword_entry (keyword, index, indent);
+          keyword->_final_index = index;
 
-      index++;
+          output_keyword_entry (buf, keyword, index, indent);
+
+          index++;
+          buf.flush_if_large (stdout);
+        }
     }
   if (index > 0)
-    printf ("\n");
+    buf.put ('\n');
 
-  printf ("%s}\n", indent);
+  buf.printf ("%s}\n\n", indent);
+  buf.write (stdout);
 }
 
 /* Generate all the tables needed for the lookup function.  */
@@ -359,44 +425,23 @@ OutputLua::output_lookup_tables () const
 void
 OutputLua::output_lookup_function_body () const
 {
-  if (option[GLOBAL])
-    {
-      printf ("    if (str:len() <= %s.%sMAX_WORD_LENGTH and str:len() >= %s.%sMIN_WORD_LENGTH) then\n"
-          "        local key = %s.%s(str)\n\n",
-          option.get_class_name (), option.get_constants_prefix (),
-          option.get_class_name (), option.get_constants_prefix (),
-          option.get_class_name (), option.get_hash_name ());
-
-      printf ("        if (key <= %s.%sMAX_HASH_VALUE and key >= 0) then\n",
-          option.get_class_name (), option.get_constants_prefix ());
-    }
-  else
-    {
-      printf ("    if (str:len() <= %sMAX_WORD_LENGTH and str:len() >= %sMIN_WORD_LENGTH) then\n"
-          "        local key = %s.%s(str)\n\n",
+  printf ("    local len = #str\n"
+          "    if (len <= %sMAX_WORD_LENGTH and len >= %sMIN_WORD_LENGTH) then\n"
+          "        local key = %s(str)\n\n",
           option.get_constants_prefix (), option.get_constants_prefix (),
-          option.get_class_name (), option.get_hash_name ());
+          option.get_hash_name ());
 
-      printf ("        if (key <= %sMAX_HASH_VALUE and key >= 0) then\n",
+  printf ("        if (key <= %sMAX_HASH_VALUE and key >= 0) then\n",
           option.get_constants_prefix ());
-    }
 
   int indent = 8;
-  if (option[GLOBAL])
-    printf ("%*s    local s = %s.%s[key + 1]",
-            indent, "", option.get_class_name (), option.get_wordlist_name ());
-  else
-    printf ("%*s    local s = %s[key + 1]",
-            indent, "", option.get_wordlist_name ());
+  printf ("%*s    local s = %s[key + 1]",
+          indent, "", option.get_wordlist_name ());
 
   printf ("\n\n"
-          "%*s    if (",
-          indent, "");
-  if (option[NULLSTRINGS])
-    printf ("s && ");
-  printf ("str == s) then\n"
+          "%*s    if (str == s) then\n"
           "%*s        return true\n",
-          indent, "");
+          indent, "", indent, "");
   printf ("%*s    end\n", indent, "");
   printf ("%*send\n",
           indent, "");
@@ -410,21 +455,39 @@ OutputLua::output_lookup_function_body () const
 void
 OutputLua::output_lookup_function () const
 {
-  printf ("\nfunction %s.%s(str)\n",
-      option.get_class_name (), option.get_function_name ());
+  printf ("\nlocal function %s(str)\n", option.get_function_name ());
 
-  if (!option[GLOBAL])
-      output_constants ("    ");
+  output_lookup_function_body ();
 
-  if (!option[GLOBAL])
-    {
-      output_lookup_tables ();
-      printf ("\n");
-    }
+  printf ("end\n"
+          "%s.%s = %s\n",
+          option.get_class_name (), option.get_function_name (),
+          option.get_function_name ());
+}
 
-  output_lookup_function_body ();
+/* Outputs the assignments that export the constants and tables, for -G.  */
+
+void
+OutputLua::output_exports () const
+{
+  const char *class_name = option.get_class_name ();
+  const char *prefix = option.get_constants_prefix ();
+  static const char * const constants[] =
+    {
+      "TOTAL_KEYWORDS", "MIN_WORD_LENGTH", "MAX_WORD_LENGTH",
+      "MIN_HASH_VALUE", "MAX_HASH_VALUE"
+    };
 
-  printf ("end\n");
+  printf ("\n");
+  for (size_t i = 0; i < sizeof (constants) / sizeof (constants[0]); i++)
+    printf ("%s.%s%s = %s%s\n",
+            class_name, prefix, constants[i], prefix, constants[i]);
+  if (!option.is_mph_algo() && _key_positions.get_size() > 0)
+    printf ("%s.asso_values = asso_values\n", class_name);
+  if (!option[NOLOOKUPFUNC])
+    printf ("%s.%s = %s\n",
+            class_name, option.get_wordlist_name (),
+            option.get_wordlist_name ());
 }
 
 void
@@ -439,7 +502,7 @@ OutputLua::output ()
   printf ("-- ");
   option.print_options ();
   printf ("\n");
-  if (!option[POSITIONS])
+  if (!option[POSITIONS] && !option.is_mph_algo())
     {
       printf ("-- Computed positions: -k'");
       _key_positions.print();
@@ -447,19 +510,29 @@ OutputLua::output ()
     }
   printf ("\n");
 
-  printf ("local %s = {}\n", option.get_class_name ());
+  printf ("local %s = {}\n\n", option.get_class_name ());
 
-  if (option[GLOBAL])
-    output_constants ("");
+  /* The tables are created once, when the chunk is loaded, and the
+     functions reach them as upvalues.  */
+  output_constants ("");
 
-  output_hash_function ();
+  output_asso_values ();
 
-  if (!option[NOLOOKUPFUNC]) {
-    if (option[GLOBAL])
-      output_lookup_tables ();
+  if (!option[NOLOOKUPFUNC])
+    output_lookup_tables ();
 
+  printf ("local byte = string.byte\n\n");
+
+  /* The tables of the MPH algorithms.  */
+  _hash_tables.write (stdout);
+
+  output_hash_function ();
+
+  if (!option[NOLOOKUPFUNC])
     output_lookup_function ();
-  }
+
+  if (option[GLOBAL])
+    output_exports ();
 
   printf ("\nreturn %s\n", option.get_class_name ());
 
@@ -36,8 +36,12 @@ protected:
   /* Outputs the maximum and minimum hash values etc.  */
   void                  output_constants (const char *indent) const;
 
+  /* Outputs the asso_values table.  */
+  void                  output_asso_values () const;
+
   /* Generates a Lua expression for an asso_values[] reference.  */
-  void                  output_asso_values_ref (int pos) const;
+  void                  output_asso_values_ref (int pos,
+                                                const char *character) const;
 
   /* Generates Lua code for the hash function that returns the
      proper encoding for each keyword.  */
@@ -54,6 +58,9 @@ protected:
 
   /* Generates Lua code for the lookup function.  */
   void                  output_lookup_function () const;
+
+  /* Outputs the assignments that export the constants and tables.  */
+  void                  output_exports () const;
 };
 
 #endif
@@ -22,18 +22,22 @@
 #include "output.h"
 
 #include <stdio.h>
-#include <iostream> /* declares cout */
 #include <string.h> /* declares strncpy(), strchr() */
 #include <ctype.h>  /* declares isprint() */
 #include <assert.h> /* defines assert() */
 #include <limits.h> /* defines SCHAR_MAX etc. */
 #include <stdarg.h> /* declares va_start() etc. */
+#include <stdlib.h> /* declares qsort() */
+#include <time.h> /* declares clock() */
 #include "options.h"
 #include "version.h"
 //#include "config.h"
 #include "nbperf.h"
 #include "output.ic"
 
+/* Alignment of the tables in the binary tables file, a cache line.  */
+#define BINARY_TABLES_ALIGNMENT 64
+
 /* ============================== Portability ============================== */
 
 /* Dynamically allocated array with dynamic extent:
@@ -68,6 +72,21 @@ static const char *const_readonly_array;
 /* The "const " qualifier, for the array type.  */
 static const char *const_for_struct;
 
+/* Whether the keys of a struct keyword table go into a separate array.  */
+static bool split_table;
+
+/* Whether the switch statements are grouped by keyword length.  */
+static bool switch_by_length;
+
+/* Whether the lookup is the compare cascade of --cascade, without hash.  */
+static bool cascade;
+
+/* The width of the keyword fingerprints, or 0.  */
+static int fingerprint_bits;
+
+/* The cache line alignment attribute for generated tables, or "".  */
+static const char *aligned_table;
+
 /* Returns the smallest unsigned C type capable of holding integers
    up to N.  */
 
@@ -145,9 +164,10 @@ Output::Output (KeywordExt_List *head,
     _alpha_inc (alpha_inc),
     _total_duplicates (total_duplicates),
     _alpha_size (alpha_size),
-    _asso_values (asso_values)
+    _asso_values (asso_values),
+    _stringpool_size (0),
+    _binary_checksum (2166136261U)
 {
-  _hash_body = vector<string>();
 }
 
 void
@@ -177,14 +197,59 @@ Output::update_searcher (KeywordExt_List *head,
 void
 Output::add_hash_body (const char *fmt, ...)
 {
-  char buffer[1024];
   va_list argptr;
-  va_start(argptr, fmt);
-  assert(strlen(fmt) < 1024);
-  vsnprintf(buffer, 1024, fmt, argptr);
-  va_end(argptr);
+  va_start (argptr, fmt);
+  _hash_body.vprintf (fmt, argptr);
+  va_end (argptr);
+}
+
+Output_Buffer&
+Output::hash_body ()
+{
+  return _hash_body;
+}
+
+Output_Buffer&
+Output::hash_tables ()
+{
+  return _hash_tables;
+}
+
+/* Returns the FNV-1a hash HASH, continued over the SIZE bytes at DATA.  */
+
+static uint32_t
+fnv1a (uint32_t hash, const void *data, size_t size)
+{
+  const unsigned char *p = static_cast<const unsigned char *>(data);
 
-  _hash_body.push_back(string(buffer));
+  for (size_t i = 0; i < size; i++)
+    hash = (hash ^ p[i]) * 16777619U;
+  return hash;
+}
+
+/* Adds a table for the MPH generators to the binary tables file: COUNT
+   elements of type TYPE, of SIZE bytes each, at DATA.  */
+
+void
+Output::add_binary_table (const char *type, const char *name,
+                          const void *data, size_t count, size_t size)
+{
+  /* Start each table at a cache line boundary of the file.  */
+  static const char zeros[BINARY_TABLES_ALIGNMENT] = { 0 };
+  size_t padding = -_binary_data.size () % BINARY_TABLES_ALIGNMENT;
+  _binary_data.put (zeros, padding);
+  _binary_checksum = fnv1a (_binary_checksum, zeros, padding);
+
+  Binary_Table table;
+  table._type = type;
+  table._name = name;
+  table._count = count;
+  table._size = count * size;
+  table._offset = _binary_data.size ();
+  _binary_tables.push_back (table);
+
+  _binary_data.put (static_cast<const char *>(data), table._size);
+  _binary_checksum = fnv1a (_binary_checksum, data, table._size);
 }
 
 /* ------------------------------------------------------------------------- */
@@ -482,14 +547,54 @@ output_upperlower_strncmp ()
   printf ("#endif\n\n");
 }
 
+/* Outputs the start of gperf_case_memcmp, which compares a word at a time
+   as long as the words are equal up to case.  This is safe because both
+   strings have n bytes.  In each word, the bytes in 'A'..'Z' are those
+   whose 7 low bits, plus 0x80 - 'A', get bit 7 set, but, plus 0x80 - 'Z'
+   - 1, don't.  Bit 7 of these bytes, shifted to bit 5, converts them to
+   lower case.  The bytes >= 0x80 are left unchanged, like gperf_downcase
+   does, unless -7 promises that there are none.  The rest of the string,
+   from the first word that differs, is compared a byte at a time.  */
+
+static void
+output_upperlower_memcmp_words ()
+{
+  printf ("  %sunsigned long ones = (unsigned long) -1 / 255;\n"
+          "  for (; n >= sizeof (unsigned long); n -= sizeof (unsigned long))\n"
+          "    {\n"
+          "      unsigned long w1, w2, m1, m2;\n"
+          "      memcpy (&w1, s1, sizeof (unsigned long));\n"
+          "      memcpy (&w2, s2, sizeof (unsigned long));\n",
+          register_scs);
+  if (option[SEVENBIT])
+    printf ("      m1 = ((w1 + (0x80 - 'A') * ones) ^ (w1 + (0x80 - 'Z' - 1) * ones))\n"
+            "           & 0x80 * ones;\n"
+            "      m2 = ((w2 + (0x80 - 'A') * ones) ^ (w2 + (0x80 - 'Z' - 1) * ones))\n"
+            "           & 0x80 * ones;\n");
+  else
+    printf ("      m1 = w1 & 0x7f * ones;\n"
+            "      m2 = w2 & 0x7f * ones;\n"
+            "      m1 = ((m1 + (0x80 - 'A') * ones) ^ (m1 + (0x80 - 'Z' - 1) * ones))\n"
+            "           & ~w1 & 0x80 * ones;\n"
+            "      m2 = ((m2 + (0x80 - 'A') * ones) ^ (m2 + (0x80 - 'Z' - 1) * ones))\n"
+            "           & ~w2 & 0x80 * ones;\n");
+  printf ("      if ((w1 | m1 >> 2) != (w2 | m2 >> 2))\n"
+          "        break;\n"
+          "      s1 += sizeof (unsigned long);\n"
+          "      s2 += sizeof (unsigned long);\n"
+          "    }\n");
+}
+
 /* Output gperf's ASCII-case insensitive memcmp replacement.  */
 
 static void
 output_upperlower_memcmp ()
 {
   printf ("#ifndef GPERF_CASE_MEMCMP\n"
-          "#define GPERF_CASE_MEMCMP 1\n"
-          "static int\n"
+          "#define GPERF_CASE_MEMCMP 1\n");
+  if (!option[INCLUDE])
+    printf ("#include <string.h>\n"); /* Declare memcpy().  */
+  printf ("static int\n"
           "gperf_case_memcmp ");
   printf (option[KRC] ?
                "(s1, s2, n)\n"
@@ -505,9 +610,10 @@ output_upperlower_memcmp ()
                "(%sconst char *s1, %sconst char *s2, %ssize_t n)\n" :
           "",
           register_scs, register_scs, register_scs);
+  printf ("{\n");
+  output_upperlower_memcmp_words ();
   #if USE_DOWNCASE_TABLE
-  printf ("{\n"
-          "  for (; n > 0;)\n"
+  printf ("  for (; n > 0;)\n"
           "    {\n"
           "      unsigned char c1 = gperf_downcase[(unsigned char)*s1++];\n"
           "      unsigned char c2 = gperf_downcase[(unsigned char)*s2++];\n"
@@ -521,8 +627,7 @@ output_upperlower_memcmp ()
           "  return 0;\n"
           "}\n");
   #else
-  printf ("{\n"
-          "  for (; n > 0;)\n"
+  printf ("  for (; n > 0;)\n"
           "    {\n"
           "      unsigned char c1 = *s1++;\n"
           "      unsigned char c2 = *s2++;\n"
@@ -545,21 +650,20 @@ output_upperlower_memcmp ()
 
 /* ------------------------------------------------------------------------- */
 
-/* Outputs a keyword, as a string: enclosed in double quotes, escaping
-   backslashes, double quote and unprintable characters.  */
+/* Outputs the characters of a keyword, escaping backslashes, double quote
+   and unprintable characters.  */
 
 static void
-output_string (const char *key, int len)
+output_string_chars (Output_Buffer& buf, const char *key, int len)
 {
-  putchar ('"');
   for (; len > 0; len--)
     {
       unsigned char c = static_cast<unsigned char>(*key++);
       if (isprint (c))
         {
           if (c == '"' || c == '\\')
-            putchar ('\\');
-          putchar (c);
+            buf.put ('\\');
+          buf.put (c);
         }
       else
         {
@@ -567,51 +671,45 @@ output_string (const char *key, int len)
              C compilers didn't understand hexadecimal escapes, and because
              hexadecimal escapes are not limited to 2 digits, thus needing
              special care if the following character happens to be a digit.  */
-          putchar ('\\');
-          putchar ('0' + ((c >> 6) & 7));
-          putchar ('0' + ((c >> 3) & 7));
-          putchar ('0' + (c & 7));
+          char escape[4];
+          escape[0] = '\\';
+          escape[1] = '0' + ((c >> 6) & 7);
+          escape[2] = '0' + ((c >> 3) & 7);
+          escape[3] = '0' + (c & 7);
+          buf.put (escape, 4);
         }
     }
-  putchar ('"');
+}
+
+/* Outputs a keyword, as a string: enclosed in double quotes, escaping
+   backslashes, double quote and unprintable characters.  */
+
+static void
+output_string (Output_Buffer& buf, const char *key, int len)
+{
+  buf.put ('"');
+  output_string_chars (buf, key, len);
+  buf.put ('"');
+}
+
+static void
+output_string (const char *key, int len)
+{
+  Output_Buffer buf;
+  output_string (buf, key, len);
+  buf.write (stdout);
 }
 
 /* Outputs a keyword as a string for MPH hashes, padded to len % 4.  */
 
 static void
-output_padded_string (const char *key, int len)
+output_padded_string (Output_Buffer& buf, const char *key, int len)
 {
-  int orig_len = len;
-  putchar ('"');
-  for (; len > 0; len--)
-    {
-      unsigned char c = static_cast<unsigned char>(*key++);
-      if (isprint (c))
-        {
-          if (c == '"' || c == '\\')
-            putchar ('\\');
-          putchar (c);
-        }
-      else
-        {
-          /* Use octal escapes, not hexadecimal escapes, because some old
-             C compilers didn't understand hexadecimal escapes, and because
-             hexadecimal escapes are not limited to 2 digits, thus needing
-             special care if the following character happens to be a digit.  */
-          putchar ('\\');
-          putchar ('0' + ((c >> 6) & 7));
-          putchar ('0' + ((c >> 3) & 7));
-          putchar ('0' + (c & 7));
-        }
-    }
-  for (; orig_len % 4 != 0; orig_len--)
-    {
-      putchar ('\\');
-      putchar ('0');
-      putchar ('0');
-      putchar ('0');
-    }
-  putchar ('"');
+  buf.put ('"');
+  output_string_chars (buf, key, len);
+  for (; len % 4 != 0; len--)
+    buf.put ("\\000", 4);
+  buf.put ('"');
 }
 
 /* ------------------------------------------------------------------------- */
@@ -619,17 +717,27 @@ output_padded_string (const char *key, int len)
 /* Outputs a #line directive, referring to the given line number.  */
 
 static void
-output_line_directive (unsigned int lineno)
+output_line_directive (Output_Buffer& buf, unsigned int lineno)
 {
   const char *file_name = option.get_input_file_name ();
   if (file_name != NULL && !option.is_mph_algo ())
     {
-      printf ("#line %u ", lineno);
-      output_string (file_name, strlen (file_name));
-      printf ("\n");
+      buf.put ("#line ");
+      buf.put_decimal (lineno, 0);
+      buf.put (' ');
+      output_string (buf, file_name, strlen (file_name));
+      buf.put ('\n');
     }
 }
 
+static void
+output_line_directive (unsigned int lineno)
+{
+  Output_Buffer buf;
+  output_line_directive (buf, lineno);
+  buf.write (stdout);
+}
+
 /* ------------------------------------------------------------------------- */
 
 /* Outputs a type and a const specifier (i.e. "const " or "").
@@ -899,7 +1007,8 @@ Output::output_asso_values_ref (int pos) const
   printf ("]");
 }
 
-/* Emits the NetBSD mi_vector_hash.c code into the output asis.  */
+/* Emits the code of the MPH hash function, e.g. NetBSD's mi_vector_hash.c,
+   into the output asis.  */
 void Output::output_mph_hash () const
 {
 
@@ -915,6 +1024,9 @@ void Output::output_mph_hash () const
     for (unsigned int i=0; i < wyhash_h_len; i++) {
       printf ("%c", wyhash_h[i]);
     }
+    for (unsigned int i=0; i < wyhash3_h_len; i++) {
+      printf ("%c", wyhash3_h[i]);
+    }
     break;
   case e_fnv3:
     for (unsigned int i=0; i < fnv3_h_len; i++) {
@@ -991,9 +1103,7 @@ Output::output_hash_function () const
 
   if (option.is_mph_algo())
     {
-      for (string s : _hash_body) {
-        cout << s;
-      }
+      _hash_body.write (stdout);
     }
   else
     {
@@ -1002,10 +1112,11 @@ Output::output_hash_function () const
         {
           /* The values in the asso_values array are all unsigned integers
              <= MAX_HASH_VALUE + 1.  */
-          printf ("  static %s%s asso_values[] =\n"
+          printf ("  static %s%s asso_values[]%s =\n"
                   "    {",
                   const_readonly_array,
-                  smallest_integral_type (_max_hash_value + 1));
+                  smallest_integral_type (_max_hash_value + 1),
+                  aligned_table);
 
           const int columns = 10;
 
@@ -1146,6 +1257,24 @@ Output::output_hash_function () const
 
 /* ------------------------------------------------------------------------- */
 
+/* Outputs what precedes an entry of a numeric table with COLUMNS entries
+   per line: the comma after the previous entry, unless FIRST, and the line
+   break and indentation at the start of a line.  */
+
+static void
+output_table_separator (Output_Buffer& buf, bool first, int column,
+                        int columns, const char *indent)
+{
+  if (!first)
+    buf.put (',');
+  if ((column % columns) == 0)
+    {
+      buf.put ('\n');
+      buf.put (indent);
+      buf.put ("   ");
+    }
+}
+
 /* Prints out a table of keyword lengths, for use with the
    comparison code in generated function 'in_word_set'.
    Only called if option[LENTABLE].  */
@@ -1156,14 +1285,15 @@ Output::output_keylength_table () const
   const int columns = 14;
   const char * const indent = option[GLOBAL] ? "" : "  ";
 
-  printf ("%sstatic %s%s %s[] =\n"
+  printf ("%sstatic %s%s %s[]%s =\n"
           "%s  {",
           indent, const_readonly_array,
           smallest_integral_type (_max_key_len),
-          option.get_lengthtable_name (),
+          option.get_lengthtable_name (), aligned_table,
           indent);
 
   /* Generate an array of lengths, similar to output_keyword_table.  */
+  Output_Buffer buf;
   unsigned int index;
   int column;
   KeywordExt_List *temp;
@@ -1184,32 +1314,111 @@ Output::output_keylength_table () const
           /* Some blank entries.  */
           for ( ; index < keyword->_hash_value; index++)
             {
-              if (index > 0)
-                printf (",");
-              if ((column++ % columns) == 0)
-                printf ("\n%s   ", indent);
-              printf ("%3d", 0);
+              output_table_separator (buf, index == 0, column++, columns,
+                                      indent);
+              buf.put_decimal (0, 3);
             }
         }
 
-      if (index > 0)
-        printf (",");
-      if ((column++ % columns) == 0)
-        printf("\n%s   ", indent);
-      printf ("%3d", keyword->_allchars_length);
+      output_table_separator (buf, index == 0, column++, columns, indent);
+      buf.put_decimal (keyword->_allchars_length, 3);
+      index++;
+
+      /* Deal with duplicates specially.  */
+      if (keyword->_duplicate_link) // implies option[DUP]
+        for (KeywordExt *links = keyword->_duplicate_link; links; links = links->_duplicate_link)
+          {
+            output_table_separator (buf, false, column++, columns, indent);
+            buf.put_decimal (links->_allchars_length, 3);
+            index++;
+          }
+      buf.flush_if_large (stdout);
+    }
+  buf.write (stdout);
+
+  printf ("\n%s  };\n", indent);
+  if (option[GLOBAL])
+    printf ("\n");
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* The fingerprint of a keyword combines its last character, its middle
+   character and its length.  The generated lookup function computes the
+   same value for the input string.  */
+
+static int
+fingerprint_multiplier ()
+{
+  return (fingerprint_bits == 8 ? 29 : 256);
+}
+
+static unsigned int
+keyword_fingerprint (const KeywordExt *keyword)
+{
+  int len = keyword->_allchars_length;
+  unsigned int last = static_cast<unsigned char>(keyword->_allchars[len - 1]);
+  unsigned int middle = static_cast<unsigned char>(keyword->_allchars[len >> 1]);
+
+  return (fingerprint_multiplier () * last + middle + len)
+         & ((1U << fingerprint_bits) - 1);
+}
+
+/* Prints out a table of keyword fingerprints, for use as a cheap filter
+   before the string comparison in the generated function 'in_word_set'.
+   Only called if fingerprint_bits is nonzero.  */
+
+void
+Output::output_fingerprint_table () const
+{
+  const int columns = (fingerprint_bits == 8 ? 14 : 10);
+  const int field_width = (fingerprint_bits == 8 ? 3 : 5);
+  const char * const indent = option[GLOBAL] ? "" : "  ";
+
+  printf ("%sstatic %s%s %s_fingerprints[]%s =\n"
+          "%s  {",
+          indent, const_readonly_array,
+          smallest_integral_type ((1 << fingerprint_bits) - 1),
+          option.get_wordlist_name (), aligned_table,
+          indent);
+
+  /* Generate an array of fingerprints, similar to output_keylength_table.  */
+  Output_Buffer buf;
+  unsigned int index;
+  int column;
+  KeywordExt_List *temp;
+
+  column = 0;
+  for (temp = _head, index = 0; temp; temp = temp->rest())
+    {
+      KeywordExt *keyword = temp->first();
+
+      if (index < keyword->_hash_value && !option[DUP])
+        {
+          /* Some blank entries.  */
+          for ( ; index < keyword->_hash_value; index++)
+            {
+              output_table_separator (buf, index == 0, column++, columns,
+                                      indent);
+              buf.put_decimal (0, field_width);
+            }
+        }
+
+      output_table_separator (buf, index == 0, column++, columns, indent);
+      buf.put_decimal (keyword_fingerprint (keyword), field_width);
       index++;
 
       /* Deal with duplicates specially.  */
       if (keyword->_duplicate_link) // implies option[DUP]
         for (KeywordExt *links = keyword->_duplicate_link; links; links = links->_duplicate_link)
           {
-            printf (",");
-            if ((column++ % columns) == 0)
-              printf("\n%s   ", indent);
-            printf ("%3d", links->_allchars_length);
+            output_table_separator (buf, false, column++, columns, indent);
+            buf.put_decimal (keyword_fingerprint (links), field_width);
             index++;
           }
+      buf.flush_if_large (stdout);
     }
+  buf.write (stdout);
 
   printf ("\n%s  };\n", indent);
   if (option[GLOBAL])
@@ -1218,6 +1427,125 @@ Output::output_keylength_table () const
 
 /* ------------------------------------------------------------------------- */
 
+/* Compares two keywords by their strings, read backwards.  */
+
+static int
+compare_reversed_strings (const void *p1, const void *p2)
+{
+  const KeywordExt *keyword1 = *static_cast<KeywordExt * const *>(p1);
+  const KeywordExt *keyword2 = *static_cast<KeywordExt * const *>(p2);
+  const unsigned char *s1 =
+    reinterpret_cast<const unsigned char *>(keyword1->_allchars)
+    + keyword1->_allchars_length;
+  const unsigned char *s2 =
+    reinterpret_cast<const unsigned char *>(keyword2->_allchars)
+    + keyword2->_allchars_length;
+  int len = (keyword1->_allchars_length < keyword2->_allchars_length
+             ? keyword1->_allchars_length : keyword2->_allchars_length);
+
+  for (; len > 0; len--)
+    {
+      int c1 = *--s1;
+      int c2 = *--s2;
+      if (c1 != c2)
+        return c1 - c2;
+    }
+  return keyword1->_allchars_length - keyword2->_allchars_length;
+}
+
+/* Assigns each keyword that goes into the string pool its offset in the
+   merged string pool.  A keyword that is a suffix of another keyword is not
+   stored separately; it points into the tail of the longer one.
+   Only called if option[MERGEDPOOL].  */
+
+void
+Output::merge_string_pool ()
+{
+  vector<KeywordExt *> strings;
+
+  for (KeywordExt_List *temp = _head; temp; temp = temp->rest())
+    {
+      KeywordExt *keyword = temp->first();
+
+      /* Same selection as in output_string_pool.  */
+      if (option[SWITCH] && !option[TYPE] && !switch_by_length
+          && !keyword->_duplicate_link)
+        continue;
+
+      strings.push_back (keyword);
+      for (KeywordExt *links = keyword->_duplicate_link; links; links = links->_duplicate_link)
+        strings.push_back (links);
+    }
+
+  /* After sorting by the reversed strings, a keyword that is a suffix of
+     some other keyword is a suffix of its successor.  Walk backwards, so
+     that the successor's offset is always known.  */
+  int count = strings.size ();
+  if (count > 0)
+    qsort (&strings[0], count, sizeof (KeywordExt *), compare_reversed_strings);
+
+  _stringpool_strings.clear ();
+  _stringpool_size = 0;
+  for (int i = count - 1; i >= 0; i--)
+    {
+      KeywordExt *keyword = strings[i];
+
+      if (i < count - 1)
+        {
+          KeywordExt *next = strings[i + 1];
+          int skip = next->_allchars_length - keyword->_allchars_length;
+
+          if (skip >= 0
+              && memcmp (next->_allchars + skip, keyword->_allchars,
+                         keyword->_allchars_length) == 0)
+            {
+              keyword->_stringpool_offset = next->_stringpool_offset + skip;
+              continue;
+            }
+        }
+      keyword->_stringpool_offset = _stringpool_size;
+      _stringpool_strings.push_back (keyword);
+      _stringpool_size += keyword->_allchars_length + 1;
+    }
+  if (_stringpool_size == 0)
+    _stringpool_size = 1;
+}
+
+/* The merged string pool, for output_merged_string_pool_entries.  */
+
+struct Output_Merged_String_Pool
+{
+  KeywordExt * const *  _strings;
+  size_t                _count;
+  const char *          _indent;
+};
+
+/* Formats the strings START ... END-1 of the Output_Merged_String_Pool DATA
+   into BUF.  Called by Output_Buffer::put_table, possibly on a worker
+   thread.  */
+
+static void
+output_merged_string_pool_entries (Output_Buffer& buf, size_t start,
+                                   size_t end, const void *data)
+{
+  const Output_Merged_String_Pool *pool =
+    static_cast<const Output_Merged_String_Pool *>(data);
+
+  for (size_t index = start; index < end; index++)
+    {
+      KeywordExt *keyword = pool->_strings[index];
+
+      if (index > 0)
+        buf.put ('\n');
+      buf.put (pool->_indent);
+      buf.put ("    \"");
+      output_string_chars (buf, keyword->_allchars, keyword->_allchars_length);
+      if (index < pool->_count - 1)
+        buf.put ("\\0");
+      buf.put ('"');
+    }
+}
+
 /* Prints out the string pool, containing the strings of the keyword table.
    Only called if option[SHAREDLIB].  */
 
@@ -1225,12 +1553,40 @@ void
 Output::output_string_pool () const
 {
   const char * const indent = option[TYPE] || option[GLOBAL] ? "" : "  ";
+  Output_Buffer buf;
   int index;
   KeywordExt_List *temp;
 
-  printf ("%sstruct %s_t\n"
-          "%s  {\n",
-          indent, option.get_stringpool_name (), indent);
+  if (option[MERGEDPOOL])
+    {
+      /* A single char array.  The terminating NUL of the last string is
+         the one implied by the string literal.  */
+      int count = _stringpool_strings.size ();
+
+      buf.printf ("%sstatic %schar %s_contents[]%s =\n",
+                  indent, const_readonly_array, option.get_stringpool_name (),
+                  aligned_table);
+      if (count == 0)
+        buf.printf ("%s  \"\"", indent);
+      Output_Merged_String_Pool pool;
+      pool._strings = _stringpool_strings.data ();
+      pool._count = count;
+      pool._indent = indent;
+      buf.put_table (count, output_merged_string_pool_entries, &pool,
+                     option.get_threads ());
+      buf.put (";\n");
+      buf.printf ("%s#define %s ((%schar *) %s_contents)\n",
+                  indent, option.get_stringpool_name (), const_always,
+                  option.get_stringpool_name ());
+      if (option[GLOBAL])
+        buf.put ('\n');
+      buf.write (stdout);
+      return;
+    }
+
+  buf.printf ("%sstruct %s_t\n"
+              "%s  {\n",
+              indent, option.get_stringpool_name (), indent);
   for (temp = _head, index = 0; temp; temp = temp->rest())
     {
       KeywordExt *keyword = temp->first();
@@ -1238,16 +1594,17 @@ Output::output_string_pool () const
       /* If generating a switch statement, and there is no user defined type,
          we generate non-duplicates directly in the code.  Only duplicates go
          into the table.  */
-      if (option[SWITCH] && !option[TYPE] && !keyword->_duplicate_link)
+      if (option[SWITCH] && !option[TYPE] && !switch_by_length
+          && !keyword->_duplicate_link)
         continue;
 
       if (!option[SWITCH] && !option[DUP])
         index = keyword->_hash_value;
 
-      printf ("%s    char %s_str%d[sizeof(",
-              indent, option.get_stringpool_name (), index);
-      output_string (keyword->_allchars, keyword->_allchars_length);
-      printf (")];\n");
+      buf.printf ("%s    char %s_str%d[sizeof(",
+                  indent, option.get_stringpool_name (), index);
+      output_string (buf, keyword->_allchars, keyword->_allchars_length);
+      buf.put (")];\n");
 
       /* Deal with duplicates specially.  */
       if (keyword->_duplicate_link) // implies option[DUP]
@@ -1257,21 +1614,22 @@ Output::output_string_pool () const
                            keyword->_allchars_length) == 0))
             {
               index++;
-              printf ("%s    char %s_str%d[sizeof(",
-                      indent, option.get_stringpool_name (), index);
-              output_string (links->_allchars, links->_allchars_length);
-              printf (")];\n");
+              buf.printf ("%s    char %s_str%d[sizeof(",
+                          indent, option.get_stringpool_name (), index);
+              output_string (buf, links->_allchars, links->_allchars_length);
+              buf.put (")];\n");
             }
 
       index++;
+      buf.flush_if_large (stdout);
     }
-  printf ("%s  };\n",
-          indent);
+  buf.printf ("%s  };\n",
+              indent);
 
-  printf ("%sstatic %sstruct %s_t %s_contents =\n"
-          "%s  {\n",
-          indent, const_readonly_array, option.get_stringpool_name (),
-          option.get_stringpool_name (), indent);
+  buf.printf ("%sstatic %sstruct %s_t %s_contents%s =\n"
+              "%s  {\n",
+              indent, const_readonly_array, option.get_stringpool_name (),
+              option.get_stringpool_name (), aligned_table, indent);
   for (temp = _head, index = 0; temp; temp = temp->rest())
     {
       KeywordExt *keyword = temp->first();
@@ -1279,18 +1637,19 @@ Output::output_string_pool () const
       /* If generating a switch statement, and there is no user defined type,
          we generate non-duplicates directly in the code.  Only duplicates go
          into the table.  */
-      if (option[SWITCH] && !option[TYPE] && !keyword->_duplicate_link)
+      if (option[SWITCH] && !option[TYPE] && !switch_by_length
+          && !keyword->_duplicate_link)
         continue;
 
       if (index > 0)
-        printf (",\n");
+        buf.put (",\n");
 
       if (!option[SWITCH] && !option[DUP])
         index = keyword->_hash_value;
 
-      printf ("%s    ",
-              indent);
-      output_string (keyword->_allchars, keyword->_allchars_length);
+      buf.put (indent);
+      buf.put ("    ");
+      output_string (buf, keyword->_allchars, keyword->_allchars_length);
 
       /* Deal with duplicates specially.  */
       if (keyword->_duplicate_link) // implies option[DUP]
@@ -1300,36 +1659,43 @@ Output::output_string_pool () const
                            keyword->_allchars_length) == 0))
             {
               index++;
-              printf (",\n");
-              printf ("%s    ",
-                      indent);
-              output_string (links->_allchars, links->_allchars_length);
+              buf.put (",\n");
+              buf.put (indent);
+              buf.put ("    ");
+              output_string (buf, links->_allchars, links->_allchars_length);
             }
 
       index++;
+      buf.flush_if_large (stdout);
     }
   if (index > 0)
-    printf ("\n");
-  printf ("%s  };\n",
-          indent);
-  printf ("%s#define %s ((%schar *) &%s_contents)\n",
-          indent, option.get_stringpool_name (), const_always,
-          option.get_stringpool_name ());
+    buf.put ('\n');
+  buf.printf ("%s  };\n",
+              indent);
+  buf.printf ("%s#define %s ((%schar *) &%s_contents)\n",
+              indent, option.get_stringpool_name (), const_always,
+              option.get_stringpool_name ());
   if (option[GLOBAL])
-    printf ("\n");
+    buf.put ('\n');
+  buf.write (stdout);
 }
 
 /* ------------------------------------------------------------------------- */
 
 static void
-output_keyword_entry (KeywordExt *temp, int stringpool_index, const char *indent, bool is_duplicate)
+output_keyword_entry (Output_Buffer& buf, KeywordExt *temp, int stringpool_index, const char *indent, bool is_duplicate, bool keys_only)
 {
-  if (option[TYPE])
-    output_line_directive (temp->_lineno);
-  printf ("%s    ", indent);
-  if (option[TYPE])
-    printf ("{");
-  if (option[SHAREDLIB])
+  const bool is_struct = option[TYPE] && !keys_only;
+
+  if (is_struct)
+    output_line_directive (buf, temp->_lineno);
+  buf.put (indent);
+  buf.put ("    ");
+  if (is_struct)
+    buf.put ('{');
+  if (option[MERGEDPOOL])
+    buf.put_decimal (temp->_stringpool_offset, 0);
+  else if (option[SHAREDLIB])
     /* How to determine a certain offset in stringpool at compile time?
        - The standard way would be to use the 'offsetof' macro.  But it is only
          defined in <stddef.h>, and <stddef.h> is not among the prerequisite
@@ -1343,37 +1709,44 @@ output_keyword_entry (KeywordExt *temp, int stringpool_index, const char *indent
        - The types 'long' and 'unsigned long' do work as well, but on 64-bit
          native Windows platforms, they don't have the same size as pointers
          and therefore generate warnings.  */
-    printf ("(int)(size_t)&((struct %s_t *)0)->%s_str%d",
-            option.get_stringpool_name (), option.get_stringpool_name (),
-            stringpool_index);
+    buf.printf ("(int)(size_t)&((struct %s_t *)0)->%s_str%d",
+                option.get_stringpool_name (), option.get_stringpool_name (),
+                stringpool_index);
   else
-    output_string (temp->_allchars, temp->_allchars_length);
-  if (option[TYPE])
+    output_string (buf, temp->_allchars, temp->_allchars_length);
+  if (is_struct)
     {
       if (strlen (temp->_rest) > 0)
-        printf (",%s", temp->_rest);
-      printf ("}");
+        {
+          buf.put (',');
+          buf.put (temp->_rest);
+        }
+      buf.put ('}');
     }
   if (option[DEBUG])
     {
-      printf (" /* ");
+      buf.put (" /* ");
       if (is_duplicate)
-        printf ("hash value duplicate, ");
+        buf.put ("hash value duplicate, ");
       else if (!option.is_mph_algo())
-        printf ("hash value = %d, ", temp->_hash_value);
-      printf ("index = %d */", temp->_final_index);
+        buf.printf ("hash value = %d, ", temp->_hash_value);
+      buf.printf ("index = %d */", temp->_final_index);
     }
 }
 
 static void
-output_nbperf_keyword_entry (char *key, uint32_t keylen, char *type_rest,
-			     uint32_t hash, uint32_t index, const char *indent)
+output_nbperf_keyword_entry (Output_Buffer& buf, char *key, uint32_t keylen, char *type_rest,
+			     uint32_t hash, uint32_t index, const char *indent,
+			     bool keys_only)
 {
+  const bool is_struct = option[TYPE] && !keys_only;
+
   //if (option[TYPE])
-  //  output_line_directive (temp->_lineno);
-  printf ("%s    ", indent);
-  if (option[TYPE])
-    printf ("{");
+  //  output_line_directive (buf, temp->_lineno);
+  buf.put (indent);
+  buf.put ("    ");
+  if (is_struct)
+    buf.put ('{');
   if (option[SHAREDLIB])
     /* How to determine a certain offset in stringpool at compile time?
        - The standard way would be to use the 'offsetof' macro.  But it is only
@@ -1388,28 +1761,32 @@ output_nbperf_keyword_entry (char *key, uint32_t keylen, char *type_rest,
        - The types 'long' and 'unsigned long' do work as well, but on 64-bit
          native Windows platforms, they don't have the same size as pointers
          and therefore generate warnings.  */
-    printf ("(int)(size_t)&((struct %s_t *)0)->%s_str%d",
-            option.get_stringpool_name (), option.get_stringpool_name (),
-            index);
+    buf.printf ("(int)(size_t)&((struct %s_t *)0)->%s_str%d",
+                option.get_stringpool_name (), option.get_stringpool_name (),
+                index);
   else if (option[PADDING])
-    output_padded_string (key, keylen);
+    output_padded_string (buf, key, keylen);
   else
-    output_padded_string (key, keylen);
-  if (option[TYPE])
+    output_padded_string (buf, key, keylen);
+  if (is_struct)
     {
       if (type_rest)
-        printf (",%s", type_rest);
-      printf ("}");
+        {
+          buf.put (',');
+          buf.put (type_rest);
+        }
+      buf.put ('}');
     }
   if (option[DEBUG])
-    printf (" \t/* hash=%u, index=%u */", hash, index);
+    buf.printf (" \t/* hash=%u, index=%u */", hash, index);
 }
 
 static void
-output_keyword_blank_entries (int count, const char *indent)
+output_keyword_blank_entries (Output_Buffer& buf, int count, const char *indent, bool keys_only)
 {
+  const bool is_struct = option[TYPE] && !keys_only;
   int columns;
-  if (option[TYPE])
+  if (is_struct)
     {
       columns = 58 / (4 + (option[SHAREDLIB] ? 2 : option[NULLSTRINGS] ? 8 : 2)
                         + strlen (option.get_initializer_suffix()));
@@ -1426,81 +1803,147 @@ output_keyword_blank_entries (int count, const char *indent)
       if ((column % columns) == 0)
         {
           if (i > 0)
-            printf (",\n");
-          printf ("%s    ", indent);
+            buf.put (",\n");
+          buf.put (indent);
+          buf.put ("    ");
         }
       else
         {
           if (i > 0)
-            printf (", ");
+            buf.put (", ");
         }
-      if (option[TYPE])
-        printf ("{");
+      if (is_struct)
+        buf.put ('{');
       if (option[SHAREDLIB])
-        printf ("-1");
+        buf.put ("-1");
       else
         {
           if (option[NULLSTRINGS])
-            printf ("(char*)0");
+            buf.put ("(char*)0");
           else
-            printf ("\"\"");
+            buf.put ("\"\"");
+        }
+      if (is_struct)
+        {
+          buf.put (option.get_initializer_suffix());
+          buf.put ('}');
         }
-      if (option[TYPE])
-        printf ("%s}", option.get_initializer_suffix());
       column++;
     }
 }
 
-/* Prints out the array containing the keywords for the hash function.  */
+/* The keyword table of an MPH algorithm, for output_nbperf_keyword_entries.  */
+
+struct Output_Nbperf_Keywords
+{
+  /* The keywords, in the order of the list and of nbperf->keys[].  */
+  KeywordExt * const *  _keywords;
+  struct nbperf *       _nbperf;
+  /* With BPZ, the keyword index of each table entry, else NULL.  */
+  const uint32_t *      _inv_map;
+  const char *          _indent;
+  bool                  _keys_only;
+};
+
+/* Formats the entries START ... END-1 of the Output_Nbperf_Keywords DATA
+   into BUF.  Called by Output_Buffer::put_table, possibly on a worker
+   thread.  */
+
+static void
+output_nbperf_keyword_entries (Output_Buffer& buf, size_t start, size_t end,
+                               const void *data)
+{
+  const Output_Nbperf_Keywords *table =
+    static_cast<const Output_Nbperf_Keywords *>(data);
+  struct nbperf *nbperf = table->_nbperf;
+
+  for (size_t i = start; i < end; i++)
+    if (table->_inv_map != NULL)
+      {
+        char *type_rest = NULL;
+        uint32_t idx = table->_inv_map[i];
+        if (option[TYPE] && !table->_keys_only)
+          type_rest = (char*)table->_keywords[idx]->_rest;
+        output_nbperf_keyword_entry (buf, (char*)nbperf->keys[idx],
+                                     nbperf->keylens[idx],
+                                     type_rest, idx, i, table->_indent,
+                                     table->_keys_only);
+        if (i == nbperf->n - 1)
+          buf.put ('\n');
+        else
+          buf.put (",\n");
+      }
+    else
+      {
+        if (i > 0)
+          buf.put (",\n");
+        output_keyword_entry (buf, table->_keywords[i], i, table->_indent,
+                              false, table->_keys_only);
+      }
+}
+
+/* Prints out the array containing the keywords for the hash function.
+   With KEYS_ONLY, prints out only the keys of a struct keyword table, in
+   the same order.  */
 
 void
-Output::output_keyword_table () const
+Output::output_keyword_table (bool keys_only) const
 {
   const char *indent  = option[GLOBAL] ? "" : "  ";
   unsigned int index = 0;
   KeywordExt_List *temp = _head;
   struct nbperf *nbperf = option.nbperf ();
+  Output_Buffer buf;
 
   printf ("%sstatic ",
           indent);
   /* FIXME static const char *const wordlist */
-  output_const_type (const_readonly_array, _wordlist_eltype);
-  printf ("%s[] =\n"
-          "%s  {\n",
-          option.get_wordlist_name (),
-          indent);
+  output_const_type (const_readonly_array,
+                     keys_only ? _wordlist_keytype : _wordlist_eltype);
+  buf.printf ("%s%s[]%s =\n"
+              "%s  {\n",
+              option.get_wordlist_name (), keys_only ? "_keys" : "",
+              aligned_table, indent);
 
   /* Generate an array of reserved words at appropriate locations.  */
-  /* With BPZ honor the nbperf->result_map ordering.  CHM is ordered.  */
-  if (option[BPZ_ALGO])
+  /* With BPZ honor the nbperf->result_map ordering.  CHM is ordered.
+     The MPH algorithms have no duplicates and no blank entries, so that
+     their tables can be formatted in chunks.  */
+  if (option.is_mph_algo())
     {
-      uint32_t* inv_map = new uint32_t[nbperf->n];
-      //uint32_t *inv_map = (uin32_t*) malloc (nbperf->n * 4);
-      for (uint32_t i = 0; i < nbperf->n; i++)
-	{
-	  uint32_t idx = nbperf->result_map[i];
-	  inv_map[idx] = i;
-	}
-      /* Quadratic (2 nested loops) with struct-type.  */
-      for (uint32_t i = 0; i < nbperf->n; i++)
-	{
-	  char *type_rest = NULL;
-	  uint32_t idx = inv_map[i];
-	  if (option[TYPE])
-	    {
-	      KeywordExt *keyword = temp->at(idx); /* slow O(n) access */
-	      type_rest = (char*)keyword->_rest;
-	    }
-	  output_nbperf_keyword_entry ((char*)nbperf->keys[idx],
-				       nbperf->keylens[idx],
-				       type_rest, idx, i, indent);
-	  if (i == nbperf->n - 1)
-	    printf ("\n");
-	  else
-	    printf (",\n");
-	}
-      free (nbperf->result_map);
-      delete[] inv_map;
+      vector<KeywordExt *> keywords;
+      for (; temp; temp = temp->rest())
+        keywords.push_back (temp->first());
+
+      Output_Nbperf_Keywords table;
+      table._keywords = keywords.data ();
+      table._nbperf = nbperf;
+      table._inv_map = NULL;
+      table._indent = indent;
+      table._keys_only = keys_only;
+      if (option[BPZ_ALGO])
+        {
+          uint32_t* inv_map = new uint32_t[nbperf->n];
+          for (uint32_t i = 0; i < nbperf->n; i++)
+            {
+              uint32_t idx = nbperf->result_map[i];
+              inv_map[idx] = i;
+            }
+          table._inv_map = inv_map;
+          buf.put_table (nbperf->n, output_nbperf_keyword_entries, &table,
+                         option.get_threads ());
+          /* The keys table is printed first and needs the map as well.  */
+          if (!keys_only)
+            free (nbperf->result_map);
+          delete[] inv_map;
+        }
+      else
+        {
+          for (index = 0; index < keywords.size (); index++)
+            keywords[index]->_final_index = index;
+          buf.put_table (keywords.size (), output_nbperf_keyword_entries,
+                         &table, option.get_threads ());
+        }
     }
   else
     {
@@ -1511,25 +1954,26 @@ Output::output_keyword_table () const
 	  /* If generating a switch statement, and there is no user defined type,
 	     we generate non-duplicates directly in the code.  Only duplicates go
 	     into the table.  */
-	  if (option[SWITCH] && !option[TYPE] && !keyword->_duplicate_link)
+	  if (option[SWITCH] && !option[TYPE] && !switch_by_length
+	      && !keyword->_duplicate_link)
 	    continue;
 
 	  if (index > 0)
-	    printf (",\n");
+	    buf.put (",\n");
 
 	  if (!option.is_mph_algo())
 	    {
 	      if (index < keyword->_hash_value && !option[SWITCH] && !option[DUP])
 		{
 		  /* Some blank entries.  */
-		  output_keyword_blank_entries (keyword->_hash_value - index, indent);
-		  printf (",\n");
+		  output_keyword_blank_entries (buf, keyword->_hash_value - index, indent, keys_only);
+		  buf.put (",\n");
 		  index = keyword->_hash_value;
 		}
 	    }
 	  keyword->_final_index = index;
 
-	  output_keyword_entry (keyword, index, indent, false);
+	  output_keyword_entry (buf, keyword, index, indent, false, keys_only);
 
 	  /* Deal with duplicates specially.  */
 	  if (keyword->_duplicate_link) // implies option[DUP]
@@ -1538,23 +1982,25 @@ Output::output_keyword_table () const
 		 links = links->_duplicate_link)
 	      {
 		links->_final_index = ++index;
-		printf (",\n");
+		buf.put (",\n");
 		int stringpool_index =
 		  (links->_allchars_length == keyword->_allchars_length
 		   && memcmp (links->_allchars, keyword->_allchars,
 			      keyword->_allchars_length) == 0
 		   ? keyword->_final_index
 		   : links->_final_index);
-		output_keyword_entry (links, stringpool_index, indent, true);
+		output_keyword_entry (buf, links, stringpool_index, indent, true, keys_only);
 	      }
 
 	  index++;
+	  buf.flush_if_large (stdout);
 	}
     }
   if (index > 0)
-    printf ("\n");
+    buf.put ('\n');
 
-  printf ("%s  };\n\n", indent);
+  buf.printf ("%s  };\n\n", indent);
+  buf.write (stdout);
 }
 
 /* ------------------------------------------------------------------------- */
@@ -1669,10 +2115,10 @@ Output::output_lookup_array () const
         }
 
       const char *indent = option[GLOBAL] ? "" : "  ";
-      printf ("%sstatic %s%s lookup[] =\n"
+      printf ("%sstatic %s%s lookup[]%s =\n"
               "%s  {",
               indent, const_readonly_array, smallest_integral_type (min, max),
-              indent);
+              aligned_table, indent);
 
       int field_width;
       /* Calculate maximum number of digits required for MIN..MAX.  */
@@ -1692,17 +2138,17 @@ Output::output_lookup_array () const
         }
 
       const int columns = 42 / field_width;
+      Output_Buffer buf;
       int column;
 
       column = 0;
       for (int i = 0; i < lookup_array_size; i++)
         {
-          if (i > 0)
-            printf (",");
-          if ((column++ % columns) == 0)
-            printf("\n%s   ", indent);
-          printf ("%*d", field_width, lookup_array[i]);
+          output_table_separator (buf, i == 0, column++, columns, indent);
+          buf.put_decimal (lookup_array[i], field_width);
+          buf.flush_if_large (stdout);
         }
+      buf.write (stdout);
       printf ("\n%s  };\n\n", indent);
 
       delete[] duplicates;
@@ -1719,7 +2165,8 @@ Output::output_lookup_pools () const
 {
   if (option[SWITCH])
     {
-      if (option[TYPE] || (option[DUP] && _total_duplicates > 0))
+      if (option[TYPE] || switch_by_length
+          || (option[DUP] && _total_duplicates > 0))
         output_string_pool ();
     }
   else
@@ -1738,43 +2185,360 @@ Output::output_lookup_tables () const
       /* Use the switch in place of lookup table.  */
       if (option[LENTABLE] && (option[DUP] && _total_duplicates > 0))
         output_keylength_table ();
-      if (option[TYPE] || (option[DUP] && _total_duplicates > 0))
-        output_keyword_table ();
+      if (option[TYPE] || switch_by_length
+          || (option[DUP] && _total_duplicates > 0))
+        output_keyword_table (false);
     }
   else
     {
       /* Use the lookup table, in place of switch.  */
       if (option[LENTABLE])
         output_keylength_table ();
-      output_keyword_table ();
+      if (fingerprint_bits)
+        output_fingerprint_table ();
+      if (split_table)
+        output_keyword_table (true);
+      output_keyword_table (false);
       output_lookup_array ();
     }
 }
 
 /* ------------------------------------------------------------------------- */
 
-/* Output a single switch case (including duplicates).  Advance list.  */
+/* The binary tables file of option[BINARYTABLES] starts with a header:
+     - the magic "GPERFTBL",
+     - the byte order mark 0x01020304, the format version 1, the number of
+       tables and the checksum of the tables, as uint32_t,
+     - the file offset and the size in bytes of each table, as uint64_t.
+   All numbers are in the byte order of the machine that runs gperf.  The
+   tables follow, each at a multiple of BINARY_TABLES_ALIGNMENT bytes.  */
 
-static KeywordExt_List *
-output_switch_case (KeywordExt_List *list, int indent, int *jumps_away)
+static size_t
+binary_tables_header_size (size_t count)
 {
-  if (option[DEBUG])
-    printf ("%*s/* hash value = %4d, keyword = \"%.*s\" */\n",
-            indent, "", list->first()->_hash_value, list->first()->_allchars_length, list->first()->_allchars);
-
-  if (option[DUP] && list->first()->_duplicate_link)
-    {
-      if (option[LENTABLE])
-        printf ("%*slengthptr = &%s[%d];\n",
-                indent, "", option.get_lengthtable_name (), list->first()->_final_index);
-      printf ("%*swordptr = &%s[%d];\n",
-              indent, "", option.get_wordlist_name (), list->first()->_final_index);
+  size_t size = 8 + 4 * 4 + count * 2 * 8;
+  return size + (-size % BINARY_TABLES_ALIGNMENT);
+}
 
-      int count = 0;
-      for (KeywordExt *links = list->first(); links; links = links->_duplicate_link)
-        count++;
+/* Adds the keyword lengths, the keyword offsets and the string pool to
+   the binary tables file, in the order of the hash values.  */
 
-      printf ("%*swordendptr = wordptr + %d;\n"
+void
+Output::add_binary_keyword_tables ()
+{
+  struct nbperf *nbperf = option.nbperf ();
+  size_t n = nbperf->n;
+  size_t i;
+
+  /* BPZ puts keyword I at hash value result_map[I], CHM at hash value I.  */
+  vector<KeywordExt *> keywords (n);
+  i = 0;
+  for (KeywordExt_List *temp = _head; temp; temp = temp->rest (), i++)
+    keywords[option[BPZ_ALGO] ? nbperf->result_map[i] : i] = temp->first ();
+  if (option[BPZ_ALGO])
+    free (nbperf->result_map);
+
+  if (option[LENTABLE])
+    {
+      const char *type = smallest_integral_type (_max_key_len);
+      if (_max_key_len <= UCHAR_MAX)
+        {
+          vector<unsigned char> lengths (n);
+          for (i = 0; i < n; i++)
+            lengths[i] = keywords[i]->_allchars_length;
+          add_binary_table (type, option.get_lengthtable_name (),
+                            lengths.data (), n, sizeof (unsigned char));
+        }
+      else if (_max_key_len <= USHRT_MAX)
+        {
+          vector<unsigned short> lengths (n);
+          for (i = 0; i < n; i++)
+            lengths[i] = keywords[i]->_allchars_length;
+          add_binary_table (type, option.get_lengthtable_name (),
+                            lengths.data (), n, sizeof (unsigned short));
+        }
+      else
+        {
+          vector<unsigned int> lengths (n);
+          for (i = 0; i < n; i++)
+            lengths[i] = keywords[i]->_allchars_length;
+          add_binary_table (type, option.get_lengthtable_name (),
+                            lengths.data (), n, sizeof (unsigned int));
+        }
+    }
+
+  /* The keywords are stored NUL terminated in the string pool, and
+     referenced by their offsets, like with option[SHAREDLIB].  */
+  vector<int32_t> offsets (n);
+  vector<char> pool;
+  for (i = 0; i < n; i++)
+    {
+      KeywordExt *keyword = keywords[i];
+      if (pool.size () >= (size_t) INT32_MAX - keyword->_allchars_length)
+        {
+          fprintf (stderr, "String pool too large for --binary-tables\n");
+          exit (1);
+        }
+      offsets[i] = pool.size ();
+      pool.insert (pool.end (), keyword->_allchars,
+                   keyword->_allchars + keyword->_allchars_length);
+      pool.push_back ('\0');
+    }
+  add_binary_table ("int32_t", option.get_wordlist_name (),
+                    offsets.data (), n, sizeof (int32_t));
+  add_binary_table ("char", option.get_stringpool_name (),
+                    pool.data (), pool.size (), sizeof (char));
+}
+
+/* Writes the binary tables file.  */
+
+void
+Output::write_binary_tables () const
+{
+  const char *file_name = option.get_binary_tables_file_name ();
+  FILE *stream = fopen (file_name, "wb");
+  if (stream == NULL)
+    {
+      fprintf (stderr, "Cannot open binary tables file '%s'\n", file_name);
+      exit (1);
+    }
+
+  size_t header_size = binary_tables_header_size (_binary_tables.size ());
+  uint32_t header[4];
+  header[0] = 0x01020304;
+  header[1] = 1;
+  header[2] = _binary_tables.size ();
+  header[3] = _binary_checksum;
+  fwrite ("GPERFTBL", 1, 8, stream);
+  fwrite (header, sizeof (uint32_t), 4, stream);
+  for (size_t i = 0; i < _binary_tables.size (); i++)
+    {
+      uint64_t entry[2];
+      entry[0] = header_size + _binary_tables[i]._offset;
+      entry[1] = _binary_tables[i]._size;
+      fwrite (entry, sizeof (uint64_t), 2, stream);
+    }
+  for (size_t i = 8 + 4 * 4 + _binary_tables.size () * 2 * 8;
+       i < header_size;
+       i++)
+    putc ('\0', stream);
+  _binary_data.write (stream);
+
+  if (ferror (stream) | fclose (stream))
+    {
+      fprintf (stderr, "Cannot write binary tables file '%s'\n", file_name);
+      exit (1);
+    }
+}
+
+/* Generates C code for the pointers to the binary tables and for the
+   functions that map and unmap the binary tables file.  The tables are
+   used through the pointers with the same code as the compiled-in
+   tables.  */
+
+void
+Output::output_binary_tables_loader () const
+{
+  const char *prefix =
+    option.get_function_name () ? option.get_function_name ()
+                                : option.get_hash_name ();
+  const char *scope = option[CPLUSPLUS] ? "::" : "";
+  const char *class_name = option[CPLUSPLUS] ? option.get_class_name () : "";
+  size_t count = _binary_tables.size ();
+
+  printf ("#include <fcntl.h>\n"
+          "#include <string.h>\n"
+          "#include <sys/mman.h>\n"
+          "#include <sys/stat.h>\n"
+          "#include <unistd.h>\n"
+          "\n");
+
+  printf ("/* The tables, mapped from the binary tables file written by gperf.  */\n"
+          "static struct\n"
+          "  {\n");
+  for (size_t i = 0; i < count; i++)
+    printf ("    const %s *%s;\n",
+            _binary_tables[i]._type, _binary_tables[i]._name);
+  printf ("    void *map;\n"
+          "    size_t map_size;\n"
+          "  } gperf_tables;\n"
+          "\n");
+
+  printf ("/* Unmaps the binary tables file.  */\n"
+          "void\n"
+          "%s%s%s_unload %s\n"
+          "{\n"
+          "  if (gperf_tables.map != NULL)\n"
+          "    munmap (gperf_tables.map, gperf_tables.map_size);\n"
+          "  memset (&gperf_tables, 0, sizeof (gperf_tables));\n"
+          "}\n"
+          "\n",
+          class_name, scope, prefix, option[C] ? "()" : "(void)");
+
+  printf ("/* Maps the binary tables FILE, which gperf wrote along with this code.\n"
+          "   Returns 0 on success, or -1 if FILE cannot be mapped or belongs to\n"
+          "   other code.  */\n"
+          "int\n"
+          "%s%s%s_load ",
+          class_name, scope, prefix);
+  printf (option[C] ?
+                 "(file)\n"
+            "     const char *file;\n" :
+          "(const char *file)\n");
+  printf ("{\n"
+          "  static const uint64_t sizes[%lu] =\n"
+          "    {\n",
+          (unsigned long) count);
+  for (size_t i = 0; i < count; i++)
+    printf ("      (uint64_t) %lu * sizeof (%s)%s\n",
+            (unsigned long) _binary_tables[i]._count, _binary_tables[i]._type,
+            i + 1 < count ? "," : "");
+  printf ("    };\n"
+          "  const unsigned char *map;\n"
+          "  const uint64_t *dir;\n"
+          "  uint32_t header[4];\n"
+          "  struct stat st;\n"
+          "  unsigned int i;\n"
+          "  int fd;\n"
+          "\n"
+          "  fd = open (file, O_RDONLY);\n"
+          "  if (fd < 0)\n"
+          "    return -1;\n"
+          "  if (fstat (fd, &st) < 0 || (uint64_t) st.st_size < %lu)\n"
+          "    {\n"
+          "      close (fd);\n"
+          "      return -1;\n"
+          "    }\n"
+          "  map = (const unsigned char *)\n"
+          "    mmap (NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);\n"
+          "  close (fd);\n"
+          "  if (map == (const unsigned char *) MAP_FAILED)\n"
+          "    return -1;\n"
+          "  memcpy (header, map + 8, sizeof (header));\n"
+          "  dir = (const uint64_t *) (map + 24);\n"
+          "  if (memcmp (map, \"GPERFTBL\", 8) != 0\n"
+          "      || header[0] != 0x01020304 || header[1] != 1\n"
+          "      || header[2] != %lu || header[3] != %#lx)\n"
+          "    goto fail;\n"
+          "  for (i = 0; i < %lu; i++)\n"
+          "    if (dir[2 * i + 1] != sizes[i]\n"
+          "        || sizes[i] > (uint64_t) st.st_size\n"
+          "        || dir[2 * i] > (uint64_t) st.st_size - sizes[i])\n"
+          "      goto fail;\n"
+          "\n"
+          "  %s_unload ();\n",
+          (unsigned long) binary_tables_header_size (count),
+          (unsigned long) count, (unsigned long) _binary_checksum,
+          (unsigned long) count, prefix);
+  for (size_t i = 0; i < count; i++)
+    printf ("  gperf_tables.%s = (const %s *) (map + dir[%lu]);\n",
+            _binary_tables[i]._name, _binary_tables[i]._type,
+            (unsigned long) (2 * i));
+  printf ("  gperf_tables.map = (void *) map;\n"
+          "  gperf_tables.map_size = st.st_size;\n"
+          "  return 0;\n"
+          "\n"
+          " fail:\n"
+          "  munmap ((void *) map, st.st_size);\n"
+          "  return -1;\n"
+          "}\n"
+          "\n");
+}
+
+/* Generates C code that embeds the binary tables file, and the pointers to
+   the binary tables in it.  C23 #embed turns the file into an array without
+   parsing an initializer per byte; other compilers get the file through
+   the .incbin directive of the GNU assembler.  */
+
+void
+Output::output_embedded_tables () const
+{
+  const char *file_name = option.get_binary_tables_file_name ();
+  size_t header_size = binary_tables_header_size (_binary_tables.size ());
+  size_t count = _binary_tables.size ();
+
+  printf ("/* The binary tables file written by gperf.  */\n"
+          "#if defined __has_embed\n"
+          "#ifdef __cplusplus\n"
+          "alignas (%d)\n"
+          "#else\n"
+          "_Alignas (%d)\n"
+          "#endif\n"
+          "static const unsigned char gperf_tables_data[] =\n"
+          "  {\n"
+          "#embed \"%s\"\n"
+          "  };\n"
+          "#else\n"
+          "__asm__ (\".section .rodata\\n\"\n"
+          "         \".balign %d\\n\"\n"
+          "         \"gperf_tables_data:\\n\"\n"
+          "         \".incbin \\\"%s\\\"\\n\"\n"
+          "         \".previous\");\n"
+          "extern const unsigned char gperf_tables_data[];\n"
+          "#endif\n"
+          "\n",
+          BINARY_TABLES_ALIGNMENT, BINARY_TABLES_ALIGNMENT, file_name,
+          BINARY_TABLES_ALIGNMENT, file_name);
+
+  printf ("/* The tables, in the binary tables file.  */\n"
+          "static const struct\n"
+          "  {\n");
+  for (size_t i = 0; i < count; i++)
+    printf ("    const %s *%s;\n",
+            _binary_tables[i]._type, _binary_tables[i]._name);
+  printf ("  } gperf_tables =\n"
+          "  {\n");
+  for (size_t i = 0; i < count; i++)
+    printf ("    (const %s *) (gperf_tables_data + %lu)%s\n",
+            _binary_tables[i]._type,
+            (unsigned long) (header_size + _binary_tables[i]._offset),
+            i + 1 < count ? "," : "");
+  printf ("  };\n"
+          "\n");
+}
+
+/* Generates C code that fetches the pointers to the keyword tables in the
+   binary tables file, in place of the tables of output_lookup_pools and
+   output_lookup_tables.  */
+
+void
+Output::output_binary_keyword_tables () const
+{
+  printf ("  const char *%s = gperf_tables.%s;\n",
+          option.get_stringpool_name (), option.get_stringpool_name ());
+  if (option[LENTABLE])
+    printf ("  const %s *%s = gperf_tables.%s;\n",
+            smallest_integral_type (_max_key_len),
+            option.get_lengthtable_name (), option.get_lengthtable_name ());
+  printf ("  const int32_t *%s = gperf_tables.%s;\n"
+          "\n",
+          option.get_wordlist_name (), option.get_wordlist_name ());
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Output a single switch case (including duplicates).  Advance list.  */
+
+static KeywordExt_List *
+output_switch_case (KeywordExt_List *list, int indent, int *jumps_away)
+{
+  if (option[DEBUG])
+    printf ("%*s/* hash value = %4d, keyword = \"%.*s\" */\n",
+            indent, "", list->first()->_hash_value, list->first()->_allchars_length, list->first()->_allchars);
+
+  if (option[DUP] && list->first()->_duplicate_link)
+    {
+      if (option[LENTABLE])
+        printf ("%*slengthptr = &%s[%d];\n",
+                indent, "", option.get_lengthtable_name (), list->first()->_final_index);
+      printf ("%*swordptr = &%s[%d];\n",
+              indent, "", option.get_wordlist_name (), list->first()->_final_index);
+
+      int count = 0;
+      for (KeywordExt *links = list->first(); links; links = links->_duplicate_link)
+        count++;
+
+      printf ("%*swordendptr = wordptr + %d;\n"
               "%*sgoto multicompare;\n",
               indent, "", count,
               indent, "");
@@ -1896,18 +2660,589 @@ output_switches (KeywordExt_List *list, int num_switches, int size, int min_hash
     }
 }
 
+/* Returns the position of the character that takes the most different
+   values among the keywords of the list, which all have the length LEN.
+   Stores the number of different values in *COUNT.  */
+
+static int
+discriminating_position (KeywordExt_List *list, int len, int *count)
+{
+  int best_pos = -1;
+  int best_count = 0;
+  for (int pos = 0; pos < len; pos++)
+    {
+      bool seen[256];
+      memset (seen, 0, sizeof (seen));
+      int pos_count = 0;
+      for (KeywordExt_List *temp = list; temp; temp = temp->rest())
+        {
+          unsigned char c = static_cast<unsigned char>(temp->first()->_allchars[pos]);
+          if (option[UPPERLOWER] && c >= 'A' && c <= 'Z')
+            c += 'a' - 'A';
+          if (!seen[c])
+            {
+              seen[c] = true;
+              pos_count++;
+            }
+        }
+      if (pos_count > best_count)
+        {
+          best_pos = pos;
+          best_count = pos_count;
+        }
+    }
+  *count = best_count;
+  return best_pos;
+}
+
+/* Outputs a case label for the character C.  */
+
+static void
+output_char_case (int indent, unsigned char c)
+{
+  if (c >= ' ' && c < 127 && c != '\'' && c != '\\')
+    printf ("%*scase '%c':\n", indent, "", c);
+  else
+    printf ("%*scase %d:\n", indent, "", c);
+}
+
+/* Outputs the assignment of the keyword's index in the keyword table.  */
+
+static void
+output_index (int indent, const KeywordExt *keyword)
+{
+  if (option[DEBUG])
+    printf ("%*s/* hash value = %4d, keyword = \"%.*s\" */\n",
+            indent, "", keyword->_hash_value,
+            keyword->_allchars_length, keyword->_allchars);
+  printf ("%*sindex = %d;\n",
+          indent, "", keyword->_final_index);
+}
+
+/* Outputs a switch on the length of the string.  In each length, the
+   keyword is selected by a switch on the character in which the keywords
+   of this length differ, or, if there is no such character, on the hash
+   value.  The cases only store the index of the keyword, and the default
+   case stores the index of some keyword of the same length, which the
+   comparison after the switch rejects.  This lets the compiler turn the
+   inner switches into table lookups.  The list is sorted by hash value
+   and has no duplicates.  */
+
+static void
+output_switches_by_length (KeywordExt_List *list, int max_key_len, int indent)
+{
+  /* Split the list into a list per length, in the same order.  */
+  KeywordExt_List **heads = new KeywordExt_List *[max_key_len + 1];
+  KeywordExt_List ***tails = new KeywordExt_List **[max_key_len + 1];
+  int *sizes = new int[max_key_len + 1];
+  for (int len = 0; len <= max_key_len; len++)
+    {
+      heads[len] = NULL;
+      tails[len] = &heads[len];
+      sizes[len] = 0;
+    }
+  for (; list; list = list->rest())
+    {
+      int len = list->first()->_allchars_length;
+      *tails[len] = new KeywordExt_List (list->first());
+      tails[len] = &(*tails[len])->rest();
+      sizes[len]++;
+    }
+
+  printf ("%*sswitch (len)\n"
+          "%*s  {\n",
+          indent, "", indent, "");
+  for (int len = 0; len <= max_key_len; len++)
+    if (heads[len])
+      {
+        KeywordExt_List *group = heads[len];
+
+        printf ("%*s    case %d:\n",
+                indent, "", len);
+        if (sizes[len] == 1)
+          output_index (indent + 6, group->first());
+        else
+          {
+            int count;
+            int pos = discriminating_position (group, len, &count);
+
+            if (count == sizes[len])
+              {
+                /* Sort the cases by character.  */
+                printf ("%*s      switch (", indent, "");
+                if (option[UPPERLOWER])
+                  printf ("gperf_downcase[(unsigned char) str[%d]]", pos);
+                else
+                  printf ("(unsigned char) str[%d]", pos);
+                printf (")\n"
+                        "%*s        {\n",
+                        indent, "");
+                for (int c = 0; c < 256; c++)
+                  for (KeywordExt_List *temp = group; temp; temp = temp->rest())
+                    {
+                      unsigned char k = static_cast<unsigned char>(temp->first()->_allchars[pos]);
+                      if (option[UPPERLOWER] && k >= 'A' && k <= 'Z')
+                        k += 'a' - 'A';
+                      if (k == c)
+                        {
+                          output_char_case (indent + 10, k);
+                          output_index (indent + 12, temp->first());
+                          printf ("%*sbreak;\n", indent + 12, "");
+                        }
+                    }
+              }
+            else
+              {
+                int lowest_case_value = group->first()->_hash_value;
+                if (lowest_case_value == 0)
+                  printf ("%*s      switch (key)\n", indent, "");
+                else
+                  printf ("%*s      switch (key - %d)\n", indent, "", lowest_case_value);
+                printf ("%*s        {\n",
+                        indent, "");
+                for (KeywordExt_List *temp = group; temp; temp = temp->rest())
+                  {
+                    printf ("%*s          case %d:\n",
+                            indent, "", temp->first()->_hash_value - lowest_case_value);
+                    output_index (indent + 12, temp->first());
+                    printf ("%*sbreak;\n", indent + 12, "");
+                  }
+              }
+            printf ("%*s          default:\n"
+                    "%*s            index = %d;\n"
+                    "%*s            break;\n"
+                    "%*s        }\n",
+                    indent, "",
+                    indent, "", group->first()->_final_index,
+                    indent, "",
+                    indent, "");
+          }
+        printf ("%*s      break;\n",
+                indent, "");
+        delete_list (heads[len]);
+      }
+  printf ("%*s    default:\n"
+          "%*s      return 0;\n"
+          "%*s  }\n",
+          indent, "", indent, "", indent, "");
+
+  delete[] sizes;
+  delete[] tails;
+  delete[] heads;
+}
+
+/* A node of the decision tree of --cascade.  A leaf holds the only keyword
+   that the string can be; an inner node selects its child by the character
+   at a position in which its keywords differ.  With --ignore-case, the
+   characters are folded to lower case.  */
+
+struct Cascade_Node
+{
+  int                   _pos;
+  const KeywordExt *    _keyword;
+  Cascade_Node *        _children[256];
+};
+
+/* Returns the character C, folded to lower case with --ignore-case.  */
+
+static inline unsigned char
+cascade_char (unsigned char c)
+{
+  if (option[UPPERLOWER] && c >= 'A' && c <= 'Z')
+    c += 'a' - 'A';
+  return c;
+}
+
+/* Builds the decision tree of the keywords of the list, which all have
+   the length LEN.  */
+
+static Cascade_Node *
+build_cascade (KeywordExt_List *list, int len)
+{
+  Cascade_Node *node = new Cascade_Node;
+  memset (node->_children, 0, sizeof (node->_children));
+  node->_keyword = list->first();
+  node->_pos = -1;
+
+  int count;
+  int pos = discriminating_position (list, len, &count);
+  /* Without a differing character, the keywords are equal, up to case.  */
+  if (count > 1)
+    {
+      node->_pos = pos;
+      KeywordExt_List *sublists[256];
+      KeywordExt_List **tails[256];
+      for (int c = 0; c < 256; c++)
+        {
+          sublists[c] = NULL;
+          tails[c] = &sublists[c];
+        }
+      for (; list; list = list->rest())
+        {
+          unsigned char c = cascade_char (list->first()->_allchars[pos]);
+          *tails[c] = new KeywordExt_List (list->first());
+          tails[c] = &(*tails[c])->rest();
+        }
+      for (int c = 0; c < 256; c++)
+        if (sublists[c])
+          {
+            node->_children[c] = build_cascade (sublists[c], len);
+            delete_list (sublists[c]);
+          }
+    }
+  return node;
+}
+
+/* Frees the decision tree.  */
+
+static void
+delete_cascade (Cascade_Node *node)
+{
+  for (int c = 0; c < 256; c++)
+    if (node->_children[c])
+      delete_cascade (node->_children[c]);
+  delete node;
+}
+
+/* Builds the decision trees of the keywords, per length.  Returns an array
+   of MAX_KEY_LEN + 1 trees, with NULL for the lengths without keywords.  */
+
+static Cascade_Node **
+build_cascades (KeywordExt_List *list, int max_key_len)
+{
+  KeywordExt_List **heads = new KeywordExt_List *[max_key_len + 1];
+  KeywordExt_List ***tails = new KeywordExt_List **[max_key_len + 1];
+  for (int len = 0; len <= max_key_len; len++)
+    {
+      heads[len] = NULL;
+      tails[len] = &heads[len];
+    }
+  for (; list; list = list->rest())
+    {
+      int len = list->first()->_allchars_length;
+      *tails[len] = new KeywordExt_List (list->first());
+      tails[len] = &(*tails[len])->rest();
+    }
+
+  Cascade_Node **roots = new Cascade_Node *[max_key_len + 1];
+  for (int len = 0; len <= max_key_len; len++)
+    if (heads[len])
+      {
+        roots[len] = build_cascade (heads[len], len);
+        delete_list (heads[len]);
+      }
+    else
+      roots[len] = NULL;
+
+  delete[] tails;
+  delete[] heads;
+  return roots;
+}
+
+/* Frees the decision trees of build_cascades.  */
+
+static void
+delete_cascades (Cascade_Node **roots, int max_key_len)
+{
+  for (int len = 0; len <= max_key_len; len++)
+    if (roots[len])
+      delete_cascade (roots[len]);
+  delete[] roots;
+}
+
+/* Outputs the code of the decision tree NODE for the strings of length
+   LEN.  Each path ends with a return statement.  */
+
+static void
+output_cascade (const Cascade_Node *node, int len, int indent)
+{
+  if (node->_pos < 0)
+    {
+      const KeywordExt *keyword = node->_keyword;
+      if (option[DEBUG])
+        printf ("%*s/* keyword = \"%.*s\" */\n",
+                indent, "", keyword->_allchars_length, keyword->_allchars);
+      /* The compiler expands a memcmp of a constant length into integer
+         loads and compares.  */
+      if (len > 0)
+        {
+          printf ("%*sif (!%smemcmp (str, ",
+                  indent, "", option[UPPERLOWER] ? "gperf_case_" : "");
+          output_string (keyword->_allchars, len);
+          printf (", %d))\n"
+                  "%*s  ",
+                  len, indent, "");
+        }
+      else
+        printf ("%*s", indent, "");
+      printf ("return ");
+      if (option[TYPE])
+        printf ("&%s[%d]", option.get_wordlist_name (), keyword->_final_index);
+      else
+        output_string (keyword->_allchars, len);
+      printf (";\n");
+      if (len > 0)
+        printf ("%*sreturn 0;\n", indent, "");
+    }
+  else
+    {
+      printf ("%*sswitch (", indent, "");
+      if (option[UPPERLOWER])
+        printf ("gperf_downcase[(unsigned char) str[%d]]", node->_pos);
+      else
+        printf ("(unsigned char) str[%d]", node->_pos);
+      printf (")\n"
+              "%*s  {\n",
+              indent, "");
+      for (int c = 0; c < 256; c++)
+        if (node->_children[c])
+          {
+            output_char_case (indent + 4, c);
+            output_cascade (node->_children[c], len, indent + 6);
+          }
+      printf ("%*s  }\n"
+              "%*sreturn 0;\n",
+              indent, "", indent, "");
+    }
+}
+
+/* Outputs the lookup of --cascade: a switch on the length of the string,
+   then the decision trees of the keywords of each length.  */
+
+static void
+output_cascades (KeywordExt_List *list, int max_key_len, int indent)
+{
+  Cascade_Node **roots = build_cascades (list, max_key_len);
+
+  printf ("%*sswitch (len)\n"
+          "%*s  {\n",
+          indent, "", indent, "");
+  for (int len = 0; len <= max_key_len; len++)
+    if (roots[len])
+      {
+        printf ("%*s    case %d:\n",
+                indent, "", len);
+        output_cascade (roots[len], len, indent + 6);
+      }
+  printf ("%*s  }\n"
+          "%*sreturn 0;\n",
+          indent, "", indent, "");
+
+  delete_cascades (roots, max_key_len);
+}
+
+/* Returns whether the string STR of length LEN equals the keyword.  */
+
+static inline bool
+cascade_equal (const char *str, int len, const KeywordExt *keyword)
+{
+  if (keyword->_allchars_length != len)
+    return false;
+  if (!option[UPPERLOWER])
+    return memcmp (str, keyword->_allchars, len) == 0;
+  for (int i = 0; i < len; i++)
+    if (cascade_char (str[i]) != cascade_char (keyword->_allchars[i]))
+      return false;
+  return true;
+}
+
+/* The largest number of keywords for which --cascade=auto considers the
+   cascade.  For more keywords, the trees get deep and the switches large.  */
+
+static const int cascade_max_keys = 64;
+
+/* The number of lookups of each round of the microbenchmark.  */
+
+static const int cascade_bench_lookups = 200000;
+
+bool
+Output::cascade_is_faster () const
+{
+  if (_total_keys > cascade_max_keys || _total_duplicates > 0)
+    return false;
+
+  /* The strings to look up: the keywords, and as many non-keywords that
+     differ from a keyword in the last character.  */
+  int num_words = 0;
+  const char **words = new const char *[2 * _total_keys];
+  int *lengths = new int[2 * _total_keys];
+  char *misses = new char[_total_keys * (_max_key_len + 1)];
+  char *miss = misses;
+  for (KeywordExt_List *temp = _head; temp; temp = temp->rest())
+    {
+      const KeywordExt *keyword = temp->first();
+      int len = keyword->_allchars_length;
+      words[num_words] = keyword->_allchars;
+      lengths[num_words++] = len;
+      if (len > 0)
+        {
+          memcpy (miss, keyword->_allchars, len);
+          miss[len - 1] ^= 1;
+          words[num_words] = miss;
+          lengths[num_words++] = len;
+          miss += _max_key_len + 1;
+        }
+    }
+
+  /* The model of the hash table: the hash function as generated, and the
+     keywords by hash value.  */
+  const KeywordExt **table = new const KeywordExt *[_max_hash_value + 1];
+  for (int i = 0; i <= _max_hash_value; i++)
+    table[i] = NULL;
+  for (KeywordExt_List *temp = _head; temp; temp = temp->rest())
+    table[temp->first()->_hash_value] = temp->first();
+
+  /* The model of the cascade: the decision trees, where the switches are
+     child tables.  */
+  Cascade_Node **roots = build_cascades (_head, _max_key_len);
+
+  int rounds = 5;
+  clock_t best_hash = 0;
+  clock_t best_cascade = 0;
+  int repetitions = cascade_bench_lookups / num_words + 1;
+  for (int round = 0; round < rounds; round++)
+    {
+      int hash_found = 0;
+      clock_t start = clock ();
+      for (int r = 0; r < repetitions; r++)
+        for (int w = 0; w < num_words; w++)
+          {
+            const char *str = words[w];
+            int len = lengths[w];
+            if (len <= _max_key_len && len >= _min_key_len)
+              {
+                unsigned int key = _hash_includes_len ? len : 0;
+                for (unsigned int i = 0; i < _key_positions.get_size(); i++)
+                  {
+                    int pos = _key_positions[i];
+                    if (pos == Positions::LASTCHAR)
+                      key += _asso_values[static_cast<unsigned char>(str[len - 1])];
+                    else if (pos < len)
+                      key += _asso_values[static_cast<unsigned char>(str[pos]) + _alpha_inc[pos]];
+                  }
+                if (key <= static_cast<unsigned int>(_max_hash_value)
+                    && table[key] && cascade_equal (str, len, table[key]))
+                  hash_found++;
+              }
+          }
+      clock_t hash_time = clock () - start;
+
+      int cascade_found = 0;
+      start = clock ();
+      for (int r = 0; r < repetitions; r++)
+        for (int w = 0; w < num_words; w++)
+          {
+            const char *str = words[w];
+            int len = lengths[w];
+            if (len <= _max_key_len)
+              {
+                const Cascade_Node *node = roots[len];
+                while (node && node->_pos >= 0)
+                  node = node->_children[cascade_char (str[node->_pos])];
+                if (node && cascade_equal (str, len, node->_keyword))
+                  cascade_found++;
+              }
+          }
+      clock_t cascade_time = clock () - start;
+
+      /* Both lookups find exactly the keywords.  */
+      assert (hash_found == cascade_found);
+
+      if (round == 0 || hash_time < best_hash)
+        best_hash = hash_time;
+      if (round == 0 || cascade_time < best_cascade)
+        best_cascade = cascade_time;
+    }
+
+  if (option[DEBUG])
+    fprintf (stderr, "--cascade=auto: %.1f ns per lookup in the hash table, %.1f ns in the cascade\n",
+             1e9 * best_hash / CLOCKS_PER_SEC / (repetitions * num_words),
+             1e9 * best_cascade / CLOCKS_PER_SEC / (repetitions * num_words));
+
+  delete_cascades (roots, _max_key_len);
+  delete[] table;
+  delete[] misses;
+  delete[] lengths;
+  delete[] words;
+
+  return best_cascade < best_hash;
+}
+
+/* Outputs the key of the keyword table entry at INDEX.  */
+
+static void
+output_key_ref (const char *index)
+{
+  if (split_table)
+    printf ("%s_keys[%s]", option.get_wordlist_name (), index);
+  else
+    {
+      printf ("%s[%s]", option.get_wordlist_name (), index);
+      if (option[TYPE])
+        printf (".%s", option.get_slot_name ());
+    }
+}
+
 /* Generates C code to perform the keyword lookup.  */
 
 void
 Output::output_lookup_function_body (const Output_Compare& comparison) const
 {
+  if (cascade)
+    {
+      output_cascades (_head, _max_key_len, 2);
+      return;
+    }
+
   printf ("  if (len <= %sMAX_WORD_LENGTH && len >= %sMIN_WORD_LENGTH)\n"
           "    {\n"
-          "      %sunsigned int key = %s (str, len);\n\n",
+          "      %sunsigned int key = %s (str, len);\n",
           option.get_constants_prefix (), option.get_constants_prefix (),
           register_scs, option.get_hash_name ());
+  if (fingerprint_bits)
+    printf ("      %sunsigned int fp =\n"
+            "        (%d * (unsigned char) str[len - 1]"
+            " + (unsigned char) str[len >> 1] + len) & %#x;\n",
+            register_scs, fingerprint_multiplier (),
+            (1U << fingerprint_bits) - 1);
+  printf ("\n");
 
-  if (option[SWITCH])
+  if (option[SWITCH] && switch_by_length)
+    {
+      printf ("      if (key <= %sMAX_HASH_VALUE",
+              option.get_constants_prefix ());
+      if (_min_hash_value > 0)
+        printf (" && key >= %sMIN_HASH_VALUE",
+                option.get_constants_prefix ());
+      printf (")\n"
+              "        {\n"
+              "          %s%s index;\n\n",
+              register_scs, smallest_integral_type (_total_keys - 1));
+
+      output_switches_by_length (_head, _max_key_len, 10);
+
+      printf ("\n"
+              "          {\n"
+              "            %s%schar *s = ",
+              register_scs, const_always);
+      output_key_ref ("index");
+      if (option[SHAREDLIB])
+        printf (" + %s",
+                option.get_stringpool_name ());
+      printf (";\n\n"
+              "            if (");
+      comparison.output_comparison (Output_Expr1 ("str"), Output_Expr1 ("s"));
+      printf (")\n"
+              "              return ");
+      if (option[TYPE])
+        printf ("&%s[index]", option.get_wordlist_name ());
+      else
+        printf ("s");
+      printf (";\n"
+              "          }\n"
+              "        }\n");
+    }
+  else if (option[SWITCH])
     {
       int switch_size = num_hash_values ();
       int num_switches = option.get_total_switches ();
@@ -2031,8 +3366,12 @@ Output::output_lookup_function_body (const Output_Compare& comparison) const
           int indent = 8;
           printf ("%*s{\n"
                   "%*s  %sint index = lookup[key];\n\n"
-                  "%*s  if (index >= 0)\n",
+                  "%*s  if (index >= 0",
                   indent, "", indent, "", register_scs, indent, "");
+          if (fingerprint_bits)
+            printf (" && fp == %s_fingerprints[index]",
+                    option.get_wordlist_name ());
+          printf (")\n");
           if (option[LENTABLE])
             {
               printf ("%*s    {\n"
@@ -2041,12 +3380,10 @@ Output::output_lookup_function_body (const Output_Compare& comparison) const
               indent += 4;
             }
           printf ("%*s    {\n"
-                  "%*s      %s%schar *s = %s[index]",
+                  "%*s      %s%schar *s = ",
                   indent, "",
-                  indent, "", register_scs, const_always,
-                  option.get_wordlist_name ());
-          if (option[TYPE])
-            printf (".%s", option.get_slot_name ());
+                  indent, "", register_scs, const_always);
+          output_key_ref ("index");
           if (option[SHAREDLIB])
             printf (" + %s",
                     option.get_stringpool_name ());
@@ -2101,7 +3438,10 @@ Output::output_lookup_function_body (const Output_Compare& comparison) const
                 }
               printf ("%*s          %s%schar *s = ",
                       indent, "", register_scs, const_always);
-              if (option[TYPE])
+              if (split_table)
+                printf ("%s_keys[wordptr - %s]",
+                        option.get_wordlist_name (), option.get_wordlist_name ());
+              else if (option[TYPE])
                 printf ("wordptr->%s", option.get_slot_name ());
               else
                 printf ("*wordptr");
@@ -2136,10 +3476,17 @@ Output::output_lookup_function_body (const Output_Compare& comparison) const
       else
         {
           int indent = option.is_mph_algo() ? 4 : 8;
-          if (option[LENTABLE])
+          if (option[LENTABLE] || fingerprint_bits)
             {
-              printf ("%*sif (len == %s[key])\n",
-                      indent, "", option.get_lengthtable_name ());
+              printf ("%*sif (", indent, "");
+              if (option[LENTABLE])
+                printf ("len == %s[key]", option.get_lengthtable_name ());
+              if (option[LENTABLE] && fingerprint_bits)
+                printf (" && ");
+              if (fingerprint_bits)
+                printf ("fp == %s_fingerprints[key]",
+                        option.get_wordlist_name ());
+              printf (")\n");
               indent += 2;
             }
 
@@ -2148,12 +3495,10 @@ Output::output_lookup_function_body (const Output_Compare& comparison) const
               if (!option[LENTABLE])
                 {
                   printf ("%*s{\n"
-                          "%*s  %sint o = %s[key]",
+                          "%*s  %sint o = ",
                           indent, "",
-                          indent, "", register_scs,
-                          option.get_wordlist_name ());
-                  if (option[TYPE])
-                    printf (".%s", option.get_slot_name ());
+                          indent, "", register_scs);
+                  output_key_ref ("key");
                   printf (";\n"
                           "%*s  if (o >= 0)\n"
                           "%*s    {\n",
@@ -2169,12 +3514,10 @@ Output::output_lookup_function_body (const Output_Compare& comparison) const
                      (len == lengthtable[key]) test already guarantees that
                      key points to nonempty table entry.  */
                   printf ("%*s{\n"
-                          "%*s  %s%schar *s = %s[key]",
+                          "%*s  %s%schar *s = ",
                           indent, "",
-                          indent, "", register_scs, const_always,
-                          option.get_wordlist_name ());
-                  if (option[TYPE])
-                    printf (".%s", option.get_slot_name ());
+                          indent, "", register_scs, const_always);
+                  output_key_ref ("key");
                 }
               printf (" + %s",
                       option.get_stringpool_name ());
@@ -2183,11 +3526,9 @@ Output::output_lookup_function_body (const Output_Compare& comparison) const
             {
 	      if (!option.is_mph_algo())
 		printf ("%*s{\n", indent, "");
-              printf ("%*s  %s%schar *s = %s[key]",
-                      indent, "", register_scs, const_always,
-                      option.get_wordlist_name ());
-              if (option[TYPE])
-                printf (".%s", option.get_slot_name ());
+              printf ("%*s  %s%schar *s = ",
+                      indent, "", register_scs, const_always);
+              output_key_ref ("key");
             }
 
           printf (";\n\n"
@@ -2210,7 +3551,8 @@ Output::output_lookup_function_body (const Output_Compare& comparison) const
               printf ("%*s    }\n",
                       indent, "");
             }
-	  if (!option.is_mph_algo())
+	  /* With option[SHAREDLIB], the block is opened for MPH too.  */
+	  if (!option.is_mph_algo() || option[SHAREDLIB])
 	    printf ("%*s}\n", indent, "");
         }
     }
@@ -2257,12 +3599,18 @@ Output::output_lookup_function () const
       output_constants (style);
     }
 
-  if (option[SHAREDLIB] && !(option[GLOBAL] || option[TYPE]))
-    output_lookup_pools ();
-  if (!option[GLOBAL])
-    output_lookup_tables ();
+  if (option[BINARYTABLES])
+    output_binary_keyword_tables ();
+  else
+    {
+      if (option[SHAREDLIB] && !(option[GLOBAL] || option[TYPE]))
+        output_lookup_pools ();
+      if (!option[GLOBAL])
+        output_lookup_tables ();
+    }
 
-  if (option[LENTABLE])
+  /* With --switch-by-length, the keyword has the length of the string.  */
+  if (option[LENTABLE] || switch_by_length)
     output_lookup_function_body (Output_Compare_Memcmp ());
   else
     {
@@ -2277,6 +3625,73 @@ Output::output_lookup_function () const
 
 /* ------------------------------------------------------------------------- */
 
+/* Outputs the check that the execution character set is based on ISO-646,
+   if the generated tables depend on it.  */
+
+void
+Output::output_charset_check () const
+{
+  if (_charset_dependent
+      && (_key_positions.get_size() > 0 || option[UPPERLOWER]))
+    {
+      /* The generated tables assume that the execution character set is
+         based on ISO-646, not EBCDIC.  */
+      printf ("#if !((' ' == 32) && ('!' == 33) && ('\"' == 34) && ('#' == 35) \\\n"
+              "      && ('%%' == 37) && ('&' == 38) && ('\\'' == 39) && ('(' == 40) \\\n"
+              "      && (')' == 41) && ('*' == 42) && ('+' == 43) && (',' == 44) \\\n"
+              "      && ('-' == 45) && ('.' == 46) && ('/' == 47) && ('0' == 48) \\\n"
+              "      && ('1' == 49) && ('2' == 50) && ('3' == 51) && ('4' == 52) \\\n"
+              "      && ('5' == 53) && ('6' == 54) && ('7' == 55) && ('8' == 56) \\\n"
+              "      && ('9' == 57) && (':' == 58) && (';' == 59) && ('<' == 60) \\\n"
+              "      && ('=' == 61) && ('>' == 62) && ('?' == 63) && ('A' == 65) \\\n"
+              "      && ('B' == 66) && ('C' == 67) && ('D' == 68) && ('E' == 69) \\\n"
+              "      && ('F' == 70) && ('G' == 71) && ('H' == 72) && ('I' == 73) \\\n"
+              "      && ('J' == 74) && ('K' == 75) && ('L' == 76) && ('M' == 77) \\\n"
+              "      && ('N' == 78) && ('O' == 79) && ('P' == 80) && ('Q' == 81) \\\n"
+              "      && ('R' == 82) && ('S' == 83) && ('T' == 84) && ('U' == 85) \\\n"
+              "      && ('V' == 86) && ('W' == 87) && ('X' == 88) && ('Y' == 89) \\\n"
+              "      && ('Z' == 90) && ('[' == 91) && ('\\\\' == 92) && (']' == 93) \\\n"
+              "      && ('^' == 94) && ('_' == 95) && ('a' == 97) && ('b' == 98) \\\n"
+              "      && ('c' == 99) && ('d' == 100) && ('e' == 101) && ('f' == 102) \\\n"
+              "      && ('g' == 103) && ('h' == 104) && ('i' == 105) && ('j' == 106) \\\n"
+              "      && ('k' == 107) && ('l' == 108) && ('m' == 109) && ('n' == 110) \\\n"
+              "      && ('o' == 111) && ('p' == 112) && ('q' == 113) && ('r' == 114) \\\n"
+              "      && ('s' == 115) && ('t' == 116) && ('u' == 117) && ('v' == 118) \\\n"
+              "      && ('w' == 119) && ('x' == 120) && ('y' == 121) && ('z' == 122) \\\n"
+              "      && ('{' == 123) && ('|' == 124) && ('}' == 125) && ('~' == 126))\n"
+              "/* The character set is not based on ISO-646.  */\n");
+      printf ("%s \"gperf generated tables don't work with this execution character set. Please report a bug to <bug-gperf@gnu.org>.\"\n", option[KRC] || option[C] ? "error" : "#error");
+      printf ("#endif\n\n");
+    }
+}
+
+/* Outputs the code from the declarations section.  */
+
+void
+Output::output_verbatim_declarations () const
+{
+  if (_verbatim_declarations < _verbatim_declarations_end)
+    {
+      output_line_directive (_verbatim_declarations_lineno);
+      fwrite (_verbatim_declarations, 1,
+              _verbatim_declarations_end - _verbatim_declarations, stdout);
+    }
+}
+
+/* Outputs the code from the end of the file.  */
+
+void
+Output::output_verbatim_code () const
+{
+  if (_verbatim_code < _verbatim_code_end)
+    {
+      output_line_directive (_verbatim_code_lineno);
+      fwrite (_verbatim_code, 1, _verbatim_code_end - _verbatim_code, stdout);
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+
 /* Generates the hash function and the key word recognizer function
    based upon the user's Options.  */
 
@@ -2311,7 +3726,62 @@ Output::output ()
       _struct_tag = (const_always[0] ? "const char *" : "char *");
     }
 
-  _wordlist_eltype = (option[SHAREDLIB] && !option[TYPE] ? "int" : _struct_tag);
+  switch_by_length = option[SWITCHBYLENGTH] && option[SWITCH];
+  if (switch_by_length && option[DUP] && _total_duplicates > 0)
+    {
+      /* The duplicates of a hash value can have different lengths.  */
+      fprintf (stderr, "--switch-by-length may not be used with duplicate keywords.\n");
+      exit (1);
+    }
+
+  /* The cascade replaces the switches of -S.  */
+  if (option[CASCADEAUTO])
+    cascade = cascade_is_faster ();
+  else
+    cascade = option[CASCADE];
+  if (cascade)
+    {
+      if (option[DUP] && _total_duplicates > 0)
+        {
+          fprintf (stderr, "--cascade may not be used with duplicate keywords.\n");
+          exit (1);
+        }
+      option.set_total_switches (1);
+    }
+
+  if (option[MERGEDPOOL])
+    merge_string_pool ();
+
+  if (option[BINARYTABLES])
+    {
+      /* The binary tables hold keywords, not the initializers of structs.  */
+      if (option[TYPE] || option[DUP])
+        {
+          fprintf (stderr, "--binary-tables and --embed-tables may not be used with -t or -D.\n");
+          exit (1);
+        }
+      add_binary_keyword_tables ();
+      write_binary_tables ();
+    }
+
+  _wordlist_keytype =
+    (option[SHAREDLIB]
+     ? (option[MERGEDPOOL]
+        ? smallest_integral_type (-1, _stringpool_size - 1)
+        : "int")
+     : const_always[0] ? "const char *" : "char *");
+  _wordlist_eltype = (option[TYPE] ? _struct_tag : _wordlist_keytype);
+
+  split_table = option[SPLITTABLE] && option[TYPE] && !option[SWITCH];
+
+  aligned_table = (option[ALIGNEDTABLES] ? " GPERF_ALIGNED" : "");
+
+  /* The fingerprint reads the last character, so it needs nonempty
+     keywords.  */
+  fingerprint_bits =
+    (!option[SWITCH] && !option.is_mph_algo () && _min_key_len > 0
+     ? option.get_fingerprint_bits ()
+     : 0);
 
   printf ("/* ");
   if (option[KRC])
@@ -2334,45 +3804,9 @@ Output::output ()
     }
   printf ("\n");
 
-  if (_charset_dependent
-      && (_key_positions.get_size() > 0 || option[UPPERLOWER]))
-    {
-      /* The generated tables assume that the execution character set is
-         based on ISO-646, not EBCDIC.  */
-      printf ("#if !((' ' == 32) && ('!' == 33) && ('\"' == 34) && ('#' == 35) \\\n"
-              "      && ('%%' == 37) && ('&' == 38) && ('\\'' == 39) && ('(' == 40) \\\n"
-              "      && (')' == 41) && ('*' == 42) && ('+' == 43) && (',' == 44) \\\n"
-              "      && ('-' == 45) && ('.' == 46) && ('/' == 47) && ('0' == 48) \\\n"
-              "      && ('1' == 49) && ('2' == 50) && ('3' == 51) && ('4' == 52) \\\n"
-              "      && ('5' == 53) && ('6' == 54) && ('7' == 55) && ('8' == 56) \\\n"
-              "      && ('9' == 57) && (':' == 58) && (';' == 59) && ('<' == 60) \\\n"
-              "      && ('=' == 61) && ('>' == 62) && ('?' == 63) && ('A' == 65) \\\n"
-              "      && ('B' == 66) && ('C' == 67) && ('D' == 68) && ('E' == 69) \\\n"
-              "      && ('F' == 70) && ('G' == 71) && ('H' == 72) && ('I' == 73) \\\n"
-              "      && ('J' == 74) && ('K' == 75) && ('L' == 76) && ('M' == 77) \\\n"
-              "      && ('N' == 78) && ('O' == 79) && ('P' == 80) && ('Q' == 81) \\\n"
-              "      && ('R' == 82) && ('S' == 83) && ('T' == 84) && ('U' == 85) \\\n"
-              "      && ('V' == 86) && ('W' == 87) && ('X' == 88) && ('Y' == 89) \\\n"
-              "      && ('Z' == 90) && ('[' == 91) && ('\\\\' == 92) && (']' == 93) \\\n"
-              "      && ('^' == 94) && ('_' == 95) && ('a' == 97) && ('b' == 98) \\\n"
-              "      && ('c' == 99) && ('d' == 100) && ('e' == 101) && ('f' == 102) \\\n"
-              "      && ('g' == 103) && ('h' == 104) && ('i' == 105) && ('j' == 106) \\\n"
-              "      && ('k' == 107) && ('l' == 108) && ('m' == 109) && ('n' == 110) \\\n"
-              "      && ('o' == 111) && ('p' == 112) && ('q' == 113) && ('r' == 114) \\\n"
-              "      && ('s' == 115) && ('t' == 116) && ('u' == 117) && ('v' == 118) \\\n"
-              "      && ('w' == 119) && ('x' == 120) && ('y' == 121) && ('z' == 122) \\\n"
-              "      && ('{' == 123) && ('|' == 124) && ('}' == 125) && ('~' == 126))\n"
-              "/* The character set is not based on ISO-646.  */\n");
-      printf ("%s \"gperf generated tables don't work with this execution character set. Please report a bug to <bug-gperf@gnu.org>.\"\n", option[KRC] || option[C] ? "error" : "#error");
-      printf ("#endif\n\n");
-    }
+  output_charset_check ();
 
-  if (_verbatim_declarations < _verbatim_declarations_end)
-    {
-      output_line_directive (_verbatim_declarations_lineno);
-      fwrite (_verbatim_declarations, 1,
-              _verbatim_declarations_end - _verbatim_declarations, stdout);
-    }
+  output_verbatim_declarations ();
 
   if (option[TYPE] && !option[NOTYPE]) /* Output type declaration now, reference it later on.... */
     {
@@ -2397,13 +3831,23 @@ Output::output ()
   printf ("/* maximum key range = %d, duplicates = %d */\n\n",
           _max_hash_value - _min_hash_value + 1, _total_duplicates);
 
+  if (option[ALIGNEDTABLES])
+    /* Start each table at a cache line boundary.  */
+    printf ("#ifndef GPERF_ALIGNED\n"
+            "#ifdef __GNUC__\n"
+            "#define GPERF_ALIGNED __attribute__ ((__aligned__ (64)))\n"
+            "#else\n"
+            "#define GPERF_ALIGNED\n"
+            "#endif\n"
+            "#endif\n\n");
+
   if (option[UPPERLOWER])
     {
       #if USE_DOWNCASE_TABLE
       output_upperlower_table ();
       #endif
 
-      if (option[LENTABLE])
+      if (option[LENTABLE] || switch_by_length || cascade)
         output_upperlower_memcmp ();
       else
         {
@@ -2422,39 +3866,50 @@ Output::output ()
 		"private:\n"
 		"  static inline unsigned int %s (const char *str, size_t len);\n"
 		"public:\n"
-		"  static %s%s%s (const char *str, size_t len);\n"
-		"};\n"
-		"\n",
+		"  static %s%s%s (const char *str, size_t len);\n",
 		option.get_class_name (), option.get_hash_name (),
 		const_for_struct, _return_type, option.get_function_name ());
       else
         printf ("class %s\n"
                 "{\n"
                 "public:\n"
-                "  static inline unsigned int %s (const char *str, size_t len);\n"
-                "};\n"
-                "\n",
+                "  static inline unsigned int %s (const char *str, size_t len);\n",
                 option.get_class_name (), option.get_hash_name ());
+      if (option[BINARYTABLES] && !option[EMBEDTABLES])
+        {
+          const char *prefix =
+            option.get_function_name () ? option.get_function_name ()
+                                        : option.get_hash_name ();
+          printf ("  static int %s_load (const char *file);\n"
+                  "  static void %s_unload (void);\n",
+                  prefix, prefix);
+        }
+      printf ("};\n"
+              "\n");
     }
 
   if (option.is_mph_algo())
     output_mph_hash();
 
+  if (option[EMBEDTABLES])
+    output_embedded_tables ();
+  else if (option[BINARYTABLES])
+    output_binary_tables_loader ();
+
   output_hash_function ();
 
-  if (option[SHAREDLIB] && (option[GLOBAL] || option[TYPE]))
-    output_lookup_pools ();
-  if (option[GLOBAL])
-    output_lookup_tables ();
+  if (!option[BINARYTABLES])
+    {
+      if (option[SHAREDLIB] && (option[GLOBAL] || option[TYPE]))
+        output_lookup_pools ();
+      if (option[GLOBAL])
+        output_lookup_tables ();
+    }
 
   if (option.get_function_name())
     output_lookup_function ();
 
-  if (_verbatim_code < _verbatim_code_end)
-    {
-      output_line_directive (_verbatim_code_lineno);
-      fwrite (_verbatim_code, 1, _verbatim_code_end - _verbatim_code, stdout);
-    }
+  output_verbatim_code ();
 
   fflush (stdout);
 }
@@ -29,6 +29,7 @@
 using namespace std;
 #include "keyword-list.h"
 #include "positions.h"
+#include "output-buffer.h"
 
 /* OSF/1 cxx needs these forward declarations. */
 struct Output_Constants;
@@ -72,12 +73,31 @@ public:
 					 unsigned int alpha_size,
 					 const int *asso_values);
 
-  /* Generates the hash function and the key word recognizer function.  */
-  void                  output ();
+  /* Frees this object.  */
+  virtual               ~Output () {}
+
+  /* Generates the hash function and the key word recognizer function.
+     Overridden by the backends for the other languages.  */
+  virtual void          output ();
 
   /* Adds C code per line for the hash function from the MPH generators.  */
   void                  add_hash_body (const char* fmt, ...);
 
+  /* Returns the buffer that add_hash_body appends to, for the MPH generators
+     to format their large tables into directly.  */
+  Output_Buffer&        hash_body ();
+
+  /* Returns the buffer for the tables of the hash function from the MPH
+     generators, for the languages that keep them outside of the function.  */
+  Output_Buffer&        hash_tables ();
+
+  /* Adds a table for the MPH generators to the binary tables file: COUNT
+     elements of type TYPE, of SIZE bytes each, at DATA.  The generated code
+     reaches the table through the pointer gperf_tables.NAME.  */
+  void                  add_binary_table (const char *type, const char *name,
+                                          const void *data, size_t count,
+                                          size_t size);
+
 protected:
 
   /* Computes the minimum and maximum hash values, and stores them
@@ -87,6 +107,16 @@ protected:
   /* Returns the number of different hash values.  */
   int                   num_hash_values () const;
 
+  /* Outputs the check that the execution character set is based on
+     ISO-646, if the generated tables depend on it.  */
+  void                  output_charset_check () const;
+
+  /* Outputs the code from the declarations section.  */
+  void                  output_verbatim_declarations () const;
+
+  /* Outputs the code from the end of the file.  */
+  void                  output_verbatim_code () const;
+
   /* Outputs C code of the mi_vector_hash() function for MPH.  */
   void                  output_mph_hash () const;
 
@@ -107,12 +137,20 @@ protected:
      comparison code in generated function 'in_word_set'.  */
   void                  output_keylength_table () const;
 
+  /* Assigns each keyword its offset in the merged string pool.  */
+  void                  merge_string_pool ();
+
+  /* Prints out a table of keyword fingerprints, for use as a cheap filter
+     before the string comparison in the generated function 'in_word_set'.  */
+  void                  output_fingerprint_table () const;
+
   /* Prints out the string pool, containing the strings of the keyword table.
    */
   void                  output_string_pool () const;
 
-  /* Prints out the array containing the keywords for the hash function.  */
-  void                  output_keyword_table () const;
+  /* Prints out the array containing the keywords for the hash function,
+     or only their keys.  */
+  void                  output_keyword_table (bool keys_only) const;
 
   /* Generates the large, sparse table that maps hash values into
      the smaller, contiguous range of the keyword table.  */
@@ -124,6 +162,29 @@ protected:
   /* Generate all the tables needed for the lookup function.  */
   void                  output_lookup_tables () const;
 
+  /* Adds the keyword lengths, the keyword offsets and the string pool to
+     the binary tables file.  */
+  void                  add_binary_keyword_tables ();
+
+  /* Writes the binary tables file.  */
+  void                  write_binary_tables () const;
+
+  /* Generates C code for the pointers to the binary tables and for the
+     functions that map and unmap the binary tables file.  */
+  void                  output_binary_tables_loader () const;
+
+  /* Generates C code that embeds the binary tables file, and the pointers
+     to the binary tables in it.  */
+  void                  output_embedded_tables () const;
+
+  /* Generates C code that fetches the pointers to the keyword tables in
+     the binary tables file.  */
+  void                  output_binary_keyword_tables () const;
+
+  /* Returns whether the lookup by --cascade is faster than the lookup in
+     the hash table, by timing models of both in this process.  */
+  bool                  cascade_is_faster () const;
+
   /* Generates C code to perform the keyword lookup.  */
   void                  output_lookup_function_body (const struct Output_Compare&) const;
 
@@ -142,6 +203,8 @@ protected:
   const char *          _struct_tag;
   /* Element type of keyword array.  */
   const char *          _wordlist_eltype;
+  /* Type of a key in the keyword array: a string or a string pool offset.  */
+  const char *          _wordlist_keytype;
   /* The C code from the declarations section.  */
   const char * const    _verbatim_declarations;
   const char * const    _verbatim_declarations_end;
@@ -175,7 +238,31 @@ protected:
   unsigned int          _alpha_size;
   /* Value associated with each character. */
   const int *           _asso_values;
-  vector<string>        _hash_body;
+  /* C code of the hash function from the MPH generators.  */
+  Output_Buffer         _hash_body;
+  /* Tables of the hash function from the MPH generators, for -L JavaScript,
+     -L Lua and --constexpr.  */
+  Output_Buffer         _hash_tables;
+  /* Keywords whose strings make up the merged string pool, in order.  */
+  vector<KeywordExt *>  _stringpool_strings;
+  /* Size of the merged string pool, including the final NUL.  */
+  int                   _stringpool_size;
+  /* A table in the binary tables file.  */
+  struct Binary_Table
+  {
+    const char *        _type;
+    const char *        _name;
+    size_t              _count;
+    size_t              _size;
+    size_t              _offset;
+  };
+  /* The tables of the binary tables file, in order.  */
+  vector<Binary_Table>  _binary_tables;
+  /* The contents of the tables of the binary tables file.  */
+  Output_Buffer         _binary_data;
+  /* FNV-1a hash of _binary_data, which identifies the binary tables file
+     that belongs to the generated code.  */
+  uint32_t              _binary_checksum;
 };
 
 #endif
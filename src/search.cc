@@ -24,9 +24,10 @@
 #include <stdio.h>
 #include <stdlib.h> /* declares exit(), rand(), srand() */
 #include <string.h> /* declares memset(), memcmp() */
-#include <time.h> /* declares time() */
+#include <time.h> /* declares time(), clock() */
 #include <math.h> /* declares exp() */
 #include <limits.h> /* defines INT_MIN, INT_MAX, UINT_MAX */
+#include <stdint.h> /* defines uint64_t */
 #include "options.h"
 #include "hash-table.h"
 //#include "config.h"
@@ -262,6 +263,342 @@ Search::count_duplicates_tuple (const Positions& positions, const unsigned int *
   return count;
 }
 
+/* Finds the positions that must occur in order to distinguish duplicates:
+   If two keywords have the same length and differ in just one position, and
+   it is not the last character, this position is mandatory.
+   Instead of comparing all pairs of keywords, the keywords of each length
+   are grouped, for each position i, by the keyword with position i masked
+   out.  Two different keywords in the same group differ exactly at i.  This
+   takes O(n * len) time instead of O(n^2 * len).  */
+
+/* Multiplier of the polynomial fingerprint of a keyword.  */
+static const uint64_t fingerprint_factor = 0x100000001b3ULL;
+
+/* Maps a fingerprint to a bucket of a table with 2^log_size entries.  */
+static inline unsigned int
+fingerprint_bucket (uint64_t fingerprint, unsigned int log_size)
+{
+  return static_cast<unsigned int>
+         ((fingerprint * 0x9E3779B97F4A7C15ULL) >> (64 - log_size));
+}
+
+void
+Search::find_mandatory_positions (Positions& mandatory) const
+{
+  /* Sort the keywords by length, using a counting sort.  */
+  unsigned int *length_start = new unsigned int[_max_key_len + 2];
+  memset (length_start, 0, (_max_key_len + 2) * sizeof (unsigned int));
+  unsigned int list_len = 0;
+  for (KeywordExt_List *temp = _head; temp; temp = temp->rest())
+    {
+      length_start[temp->first()->_allchars_length + 1]++;
+      list_len++;
+    }
+  for (int len = 0; len <= _max_key_len; len++)
+    length_start[len + 1] += length_start[len];
+  KeywordExt **by_length = new KeywordExt*[list_len];
+  {
+    unsigned int *fill = new unsigned int[_max_key_len + 1];
+    memcpy (fill, length_start, (_max_key_len + 1) * sizeof (unsigned int));
+    for (KeywordExt_List *temp = _head; temp; temp = temp->rest())
+      by_length[fill[temp->first()->_allchars_length]++] = temp->first();
+    delete[] fill;
+  }
+
+  /* powers[j] = fingerprint_factor^j.  */
+  uint64_t *powers = new uint64_t[_max_key_len];
+  powers[0] = 1;
+  for (int j = 1; j < _max_key_len; j++)
+    powers[j] = powers[j - 1] * fingerprint_factor;
+
+  for (int n = 2; n <= _max_key_len; n++)
+    {
+      unsigned int group_size = length_start[n + 1] - length_start[n];
+      if (group_size < 2)
+        continue;
+      KeywordExt **group = by_length + length_start[n];
+
+      /* The (case folded) characters and the fingerprint of each keyword.  */
+      unsigned char *chars = new unsigned char[group_size * n];
+      uint64_t *fingerprints = new uint64_t[group_size];
+      for (unsigned int k = 0; k < group_size; k++)
+        {
+          unsigned char *p = chars + k * n;
+          uint64_t fingerprint = 0;
+          for (int j = 0; j < n; j++)
+            {
+              unsigned char c = group[k]->_allchars[j];
+              if (option[UPPERLOWER])
+                {
+                  if (c >= 'A' && c <= 'Z')
+                    c += 'a' - 'A';
+                }
+              p[j] = c;
+              fingerprint = fingerprint * fingerprint_factor + c;
+            }
+          fingerprints[k] = fingerprint;
+        }
+
+      /* Open addressing hash table, big enough for the entire group.  */
+      unsigned int log_size = 1;
+      while ((1U << log_size) < 2 * group_size)
+        log_size++;
+      unsigned int table_size = 1U << log_size;
+      unsigned int table_mask = table_size - 1;
+      int *table = new int[table_size];
+      uint64_t *table_fingerprints = new uint64_t[table_size];
+
+      /* Drop keywords that are equal (after case folding) to an earlier
+         keyword.  They are equal at all positions, therefore they don't
+         make any position mandatory.  */
+      unsigned int *distinct = new unsigned int[group_size];
+      unsigned int distinct_count = 0;
+      memset (table, -1, table_size * sizeof (int));
+      for (unsigned int k = 0; k < group_size; k++)
+        {
+          uint64_t fingerprint = fingerprints[k];
+          unsigned int b = fingerprint_bucket (fingerprint, log_size);
+          for (; table[b] >= 0; b = (b + 1) & table_mask)
+            if (table_fingerprints[b] == fingerprint
+                && memcmp (chars + table[b] * n, chars + k * n, n) == 0)
+              break;
+          if (table[b] < 0)
+            {
+              table[b] = k;
+              table_fingerprints[b] = fingerprint;
+              distinct[distinct_count++] = k;
+            }
+        }
+
+      if (distinct_count >= 2)
+        for (int i = 0; i < n - 1; i++)
+          if (!mandatory.contains (i))
+            {
+              memset (table, -1, table_size * sizeof (int));
+              for (unsigned int d = 0; d < distinct_count; d++)
+                {
+                  unsigned int k = distinct[d];
+                  const unsigned char *p = chars + k * n;
+                  uint64_t fingerprint =
+                    fingerprints[k] - p[i] * powers[n - 1 - i];
+                  unsigned int b = fingerprint_bucket (fingerprint, log_size);
+                  for (; table[b] >= 0; b = (b + 1) & table_mask)
+                    if (table_fingerprints[b] == fingerprint)
+                      {
+                        const unsigned char *q = chars + table[b] * n;
+                        if (memcmp (p, q, i) == 0
+                            && memcmp (p + i + 1, q + i + 1, n - 1 - i) == 0)
+                          break;
+                      }
+                  if (table[b] >= 0)
+                    {
+                      /* Two different keywords that agree everywhere except
+                         at position i.  Position i is mandatory.  */
+                      mandatory.add (i);
+                      break;
+                    }
+                  table[b] = k;
+                  table_fingerprints[b] = fingerprint;
+                }
+            }
+
+      delete[] distinct;
+      delete[] table_fingerprints;
+      delete[] table;
+      delete[] fingerprints;
+      delete[] chars;
+    }
+
+  delete[] powers;
+  delete[] by_length;
+  delete[] length_start;
+}
+
+/* Counts the duplicate keywords that occur with a given set of positions,
+   like count_duplicates_tuple, but faster: Each keyword's tuple is
+   represented by a fingerprint, namely a sum of one term per position.  The
+   fingerprints for a base set of positions are computed once; a set of
+   positions that differs from the base set in a few positions is then
+   evaluated in a single pass over the keywords, without allocating memory.
+   Keywords with equal fingerprints are compared exactly, so the result is
+   the same as that of count_duplicates_tuple.  */
+
+class Tuple_Duplicate_Counter
+{
+public:
+                        Tuple_Duplicate_Counter (KeywordExt_List *head, int total_keys, bool ignore_length, const unsigned int *alpha_unify);
+                        ~Tuple_Duplicate_Counter ();
+  /* Sets the base set of positions.  */
+  void                  set_base (const Positions& positions);
+  /* Count the duplicate keywords that occur with POSITIONS.  */
+  unsigned int          count (const Positions& positions);
+private:
+  /* Returns the value that the tuple of KEYWORD has at position POS, or
+     UINT_MAX if POS is not a valid position for KEYWORD.  */
+  unsigned int          value (const KeywordExt *keyword, int pos) const;
+  /* Returns the fingerprint term of KEYWORD at position POS.  */
+  uint64_t              term (const KeywordExt *keyword, int pos) const;
+  /* Tests whether the tuples of KEYWORD1 and KEYWORD2 are equal.  */
+  bool                  equal (const KeywordExt *keyword1, const KeywordExt *keyword2, const Positions& positions) const;
+
+  int const             _total_keys;
+  bool const            _ignore_length;
+  const unsigned int * const _alpha_unify;
+  /* The keywords.  */
+  KeywordExt ** const   _keywords;
+  /* The base set of positions.  */
+  Positions             _base;
+  /* The fingerprint of each keyword's tuple for _base.  */
+  uint64_t * const      _base_fingerprints;
+  /* Open addressing hash table of 2^_log_size entries, holding indices into
+     _keywords (or -1 for an empty entry) and their fingerprints.  */
+  unsigned int          _log_size;
+  int *                 _table;
+  uint64_t *            _table_fingerprints;
+};
+
+Tuple_Duplicate_Counter::Tuple_Duplicate_Counter (KeywordExt_List *head, int total_keys, bool ignore_length, const unsigned int *alpha_unify)
+  : _total_keys (total_keys),
+    _ignore_length (ignore_length),
+    _alpha_unify (alpha_unify),
+    _keywords (new KeywordExt*[total_keys]),
+    _base_fingerprints (new uint64_t[total_keys])
+{
+  int k = 0;
+  for (KeywordExt_List *temp = head; temp; temp = temp->rest())
+    _keywords[k++] = temp->first();
+
+  _log_size = 1;
+  while ((1 << _log_size) < 2 * total_keys)
+    _log_size++;
+  _table = new int[1 << _log_size];
+  _table_fingerprints = new uint64_t[1 << _log_size];
+
+  set_base (Positions ());
+}
+
+Tuple_Duplicate_Counter::~Tuple_Duplicate_Counter ()
+{
+  delete[] _table_fingerprints;
+  delete[] _table;
+  delete[] _base_fingerprints;
+  delete[] _keywords;
+}
+
+inline unsigned int
+Tuple_Duplicate_Counter::value (const KeywordExt *keyword, int pos) const
+{
+  unsigned int c;
+  if (pos == Positions::LASTCHAR)
+    c = static_cast<unsigned char>(keyword->_allchars[keyword->_allchars_length - 1]);
+  else if (pos < keyword->_allchars_length)
+    c = static_cast<unsigned char>(keyword->_allchars[pos]);
+  else
+    return UINT_MAX;
+  if (_alpha_unify)
+    c = _alpha_unify[c];
+  return c;
+}
+
+inline uint64_t
+Tuple_Duplicate_Counter::term (const KeywordExt *keyword, int pos) const
+{
+  unsigned int c = value (keyword, pos);
+  if (c == UINT_MAX)
+    return 0;
+  /* Mix the position and the character, so that the sum of the terms
+     distinguishes different tuples.  */
+  uint64_t x = (static_cast<uint64_t>(pos + 2) << 32) | c;
+  x *= 0x9E3779B97F4A7C15ULL;
+  x ^= x >> 29;
+  x *= 0xBF58476D1CE4E5B9ULL;
+  x ^= x >> 32;
+  return x;
+}
+
+bool
+Tuple_Duplicate_Counter::equal (const KeywordExt *keyword1, const KeywordExt *keyword2, const Positions& positions) const
+{
+  if (!_ignore_length
+      && keyword1->_allchars_length != keyword2->_allchars_length)
+    return false;
+  PositionIterator iter = positions.iterator();
+  for (int i; (i = iter.next ()) != PositionIterator::EOS; )
+    if (value (keyword1, i) != value (keyword2, i))
+      return false;
+  return true;
+}
+
+void
+Tuple_Duplicate_Counter::set_base (const Positions& positions)
+{
+  _base = positions;
+  for (int k = 0; k < _total_keys; k++)
+    {
+      const KeywordExt *keyword = _keywords[k];
+      uint64_t fingerprint = 0;
+      PositionIterator iter = positions.iterator(keyword->_allchars_length);
+      for (int i; (i = iter.next ()) != PositionIterator::EOS; )
+        fingerprint += term (keyword, i);
+      if (!_ignore_length)
+        fingerprint += static_cast<uint64_t>(keyword->_allchars_length)
+                       * 0xD6E8FEB86659FD93ULL;
+      _base_fingerprints[k] = fingerprint;
+    }
+}
+
+unsigned int
+Tuple_Duplicate_Counter::count (const Positions& positions)
+{
+  /* Determine the positions that differ from _base.  */
+  int added[Positions::MAX_SIZE];
+  int removed[Positions::MAX_SIZE];
+  unsigned int added_count = 0;
+  unsigned int removed_count = 0;
+  {
+    PositionIterator iter = positions.iterator();
+    for (int i; (i = iter.next ()) != PositionIterator::EOS; )
+      if (!_base.contains (i))
+        added[added_count++] = i;
+  }
+  {
+    PositionIterator iter = _base.iterator();
+    for (int i; (i = iter.next ()) != PositionIterator::EOS; )
+      if (!positions.contains (i))
+        removed[removed_count++] = i;
+  }
+
+  /* Run through the keywords and count the duplicates incrementally.  */
+  unsigned int mask = (1U << _log_size) - 1;
+  memset (_table, -1, (1U << _log_size) * sizeof (int));
+  unsigned int count = 0;
+  for (int k = 0; k < _total_keys; k++)
+    {
+      const KeywordExt *keyword = _keywords[k];
+      uint64_t fingerprint = _base_fingerprints[k];
+      for (unsigned int j = 0; j < added_count; j++)
+        fingerprint += term (keyword, added[j]);
+      for (unsigned int j = 0; j < removed_count; j++)
+        fingerprint -= term (keyword, removed[j]);
+
+      unsigned int b =
+        static_cast<unsigned int>((fingerprint * 0x9E3779B97F4A7C15ULL)
+                                  >> (64 - _log_size));
+      for (; _table[b] >= 0; b = (b + 1) & mask)
+        if (_table_fingerprints[b] == fingerprint
+            && equal (_keywords[_table[b]], keyword, positions))
+          break;
+      if (_table[b] >= 0)
+        count++;
+      else
+        {
+          _table[b] = k;
+          _table_fingerprints[b] = fingerprint;
+        }
+    }
+  return count;
+}
+
 /* Find good key positions for the default gperf algo.  */
 
 void
@@ -281,82 +618,30 @@ Search::find_positions ()
   Positions mandatory;
 
   if (!option[DUP])
-    {
-      for (KeywordExt_List *l1 = _head; l1 && l1->rest(); l1 = l1->rest())
-        {
-          KeywordExt *keyword1 = l1->first();
-          for (KeywordExt_List *l2 = l1->rest(); l2; l2 = l2->rest())
-            {
-              KeywordExt *keyword2 = l2->first();
-
-              /* If keyword1 and keyword2 have the same length and differ
-                 in just one position, and it is not the last character,
-                 this position is mandatory.  */
-              if (keyword1->_allchars_length == keyword2->_allchars_length)
-                {
-                  int n = keyword1->_allchars_length;
-                  int i;
-                  for (i = 0; i < n - 1; i++)
-                    {
-                      unsigned char c1 = keyword1->_allchars[i];
-                      unsigned char c2 = keyword2->_allchars[i];
-                      if (option[UPPERLOWER])
-                        {
-                          if (c1 >= 'A' && c1 <= 'Z')
-                            c1 += 'a' - 'A';
-                          if (c2 >= 'A' && c2 <= 'Z')
-                            c2 += 'a' - 'A';
-                        }
-                      if (c1 != c2)
-                        break;
-                    }
-                  if (i < n - 1)
-                    {
-                      int j;
-                      for (j = i + 1; j < n; j++)
-                        {
-                          unsigned char c1 = keyword1->_allchars[j];
-                          unsigned char c2 = keyword2->_allchars[j];
-                          if (option[UPPERLOWER])
-                            {
-                              if (c1 >= 'A' && c1 <= 'Z')
-                                c1 += 'a' - 'A';
-                              if (c2 >= 'A' && c2 <= 'Z')
-                                c2 += 'a' - 'A';
-                            }
-                          if (c1 != c2)
-                            break;
-                        }
-                      if (j >= n)
-                        {
-                          /* Position i is mandatory.  */
-                          if (!mandatory.contains (i))
-                            mandatory.add (i);
-                        }
-                    }
-                }
-            }
-        }
-    }
+    find_mandatory_positions (mandatory);
 
   /* 2. Add positions, as long as this decreases the duplicates count.  */
   int imax = (_max_key_len - 1 < Positions::MAX_KEY_POS - 1
               ? _max_key_len - 1 : Positions::MAX_KEY_POS - 1);
   Positions current = mandatory;
+  Tuple_Duplicate_Counter counter (_head, _total_keys, !_hash_includes_len,
+                                   alpha_unify);
   unsigned int current_duplicates_count =
-    count_duplicates_tuple (current, alpha_unify);
+    counter.count (current);
   for (;;)
     {
       Positions best;
       unsigned int best_duplicates_count = UINT_MAX;
 
+      counter.set_base (current);
+
       for (int i = imax; i >= -1; i--)
         if (!current.contains (i))
           {
             Positions tryal = current;
             tryal.add (i);
             unsigned int try_duplicates_count =
-              count_duplicates_tuple (tryal, alpha_unify);
+              counter.count (tryal);
 
             /* We prefer 'try' to 'best' if it produces less duplicates,
                or if it produces the same number of duplicates but with
@@ -384,13 +669,15 @@ Search::find_positions ()
       Positions best;
       unsigned int best_duplicates_count = UINT_MAX;
 
+      counter.set_base (current);
+
       for (int i = imax; i >= -1; i--)
         if (current.contains (i) && !mandatory.contains (i))
           {
             Positions tryal = current;
             tryal.remove (i);
             unsigned int try_duplicates_count =
-              count_duplicates_tuple (tryal, alpha_unify);
+              counter.count (tryal);
 
             /* We prefer 'try' to 'best' if it produces less duplicates,
                or if it produces the same number of duplicates but with
@@ -418,6 +705,8 @@ Search::find_positions ()
       Positions best;
       unsigned int best_duplicates_count = UINT_MAX;
 
+      counter.set_base (current);
+
       /* Loop over all pairs { i1, i2 } of currently selected positions.
          W.l.o.g. we can assume i1 > i2.  */
       for (int i1 = imax; i1 >= -1; i1--)
@@ -434,7 +723,7 @@ Search::find_positions ()
                         tryal.remove (i2);
                         tryal.add (i3);
                         unsigned int try_duplicates_count =
-                          count_duplicates_tuple (tryal, alpha_unify);
+                          counter.count (tryal);
 
                         /* We prefer 'try' to 'best' if it produces less
                            duplicates, or if it produces the same number
@@ -595,9 +884,10 @@ Search::init_selchars_multiset (const Positions& positions, const unsigned int *
    and a given alpha_inc[] array.
    In other words, it returns the difference
      # K - # proj2 (proj1 (K))
-   where K is the multiset of given keywords.  */
+   where K is the multiset of given keywords.
+   REPRESENTATIVES is a scratch table, sized for _total_keys entries.  */
 unsigned int
-Search::count_duplicates_multiset (const unsigned int *alpha_inc) const
+Search::count_duplicates_multiset (const unsigned int *alpha_inc, Hash_Table& representatives) const
 {
   /* Run through the keyword list and count the duplicates incrementally.
      The result does not depend on the order of the keyword list, thanks to
@@ -606,15 +896,13 @@ Search::count_duplicates_multiset (const unsigned int *alpha_inc) const
   init_selchars_multiset (_key_positions, alpha_unify, alpha_inc);
 
   unsigned int count = 0;
-  {
-    Hash_Table representatives (_total_keys, !_hash_includes_len);
-    for (KeywordExt_List *temp = _head; temp; temp = temp->rest())
-      {
-        KeywordExt *keyword = temp->first();
-        if (representatives.insert (keyword))
-          count++;
-      }
-  }
+  representatives.clear ();
+  for (KeywordExt_List *temp = _head; temp; temp = temp->rest())
+    {
+      KeywordExt *keyword = temp->first();
+      if (representatives.insert (keyword))
+        count++;
+    }
 
   delete_selchars ();
   delete[] alpha_unify;
@@ -636,7 +924,10 @@ Search::find_alpha_inc ()
   unsigned int *current = new unsigned int [_max_key_len];
   for (int i = 0; i < _max_key_len; i++)
     current[i] = 0;
-  unsigned int current_duplicates_count = count_duplicates_multiset (current);
+  /* The table for counting duplicates, reused for all tries.  */
+  Hash_Table representatives (_total_keys, !_hash_includes_len);
+  unsigned int current_duplicates_count =
+    count_duplicates_multiset (current, representatives);
 
   if (current_duplicates_count > duplicates_goal)
     {
@@ -689,7 +980,7 @@ Search::find_alpha_inc ()
                   memcpy (tryal, current, _max_key_len * sizeof (unsigned int));
                   tryal[indices[j]] += inc;
                   unsigned int try_duplicates_count =
-                    count_duplicates_multiset (tryal);
+                    count_duplicates_multiset (tryal, representatives);
 
                   /* We prefer 'try' to 'best' if it produces less
                      duplicates.  */
@@ -1505,8 +1796,9 @@ Search::find_good_asso_values ()
   prepare_asso_values ();
 
   /* Search for good _asso_values[].  */
-  int asso_iteration;
-  if ((asso_iteration = option.get_asso_iterations ()) == 0)
+  int asso_iteration = option.get_asso_iterations ();
+  float time_budget = option.get_time_budget ();
+  if (asso_iteration == 0 && time_budget == 0)
     /* Try only the given _initial_asso_value and _jump.  */
     find_asso_values ();
   else
@@ -1526,6 +1818,7 @@ Search::find_good_asso_values ()
       int *best_asso_values = new int[_alpha_size];
       int best_collisions = INT_MAX;
       int best_max_hash_value = INT_MAX;
+      int tries = 0;
 
       _initial_asso_value = 0; _jump = 1;
       for (;;)
@@ -1559,8 +1852,15 @@ Search::find_good_asso_values ()
           /* Delete the copied keyword list.  */
           delete_list (_head);
 
+          tries++;
+
+          /* With -m, stop after the given number of iterations.  With only
+             a time budget, asso_iteration never reaches 0 here.  */
           if (--asso_iteration == 0)
             break;
+          /* Stop when the time budget is used up.  */
+          if (time_budget > 0 && search_time () >= time_budget)
+            break;
           /* Prepare for next iteration.  */
           if (_initial_asso_value >= 2)
             _initial_asso_value -= 2, _jump += 2;
@@ -1568,6 +1868,10 @@ Search::find_good_asso_values ()
             _initial_asso_value += _jump, _jump = 1;
         }
       _head = saved_head;
+      if (option[DEBUG])
+        fprintf (stderr, "\ntried %d choices of initial asso_value and jump"
+                 " in %g seconds, best max hash value = %d\n",
+                 tries, search_time (), best_max_hash_value);
       /* Install the best found asso_values.  */
       _initial_asso_value = best_initial_asso_value;
       _jump = best_jump;
@@ -1595,9 +1899,19 @@ Search::sort ()
   _head = mergesort_list (_head, less_by_hash_value);
 }
 
+/* Returns the processor time, in seconds, spent since the search started.  */
+
+float
+Search::search_time () const
+{
+  return static_cast<float>(clock () - _start_time) / CLOCKS_PER_SEC;
+}
+
 void
 Search::optimize ()
 {
+  _start_time = clock ();
+
   /* Preparations.  */
   prepare ();
 
@@ -1607,6 +1921,23 @@ Search::optimize ()
       int i = 0;
       uint32_t max_iterations = 0xffffffU;
       struct nbperf *nbperf = option.nbperf();
+      /* With --ignore-case, the keys are hashed folded to lower case, and
+         the generated C code folds the input while hashing it, which only
+         fnv3 and wyhash implement.  The JavaScript and Lua code compares
+         the keywords case sensitively.  */
+      const bool fold_case =
+        option[UPPERLOWER] && !option[JAVASCRIPT] && !option[LUA];
+
+      if (fold_case)
+        {
+          option.set_mph_hash_function (e_fnv3);
+          if (option.get_mph_hash_function () != e_fnv3
+              && option.get_mph_hash_function () != e_wyhash)
+            {
+              fprintf (stderr, "--ignore-case with --chm, --chm3 or --bpz supports only --mph-hash-function=fnv3 or wyhash.\n");
+              exit (1);
+            }
+        }
 
       char** keys = (char**)malloc(_total_keys * sizeof(char*));
       size_t *keylens = (size_t *)malloc(_total_keys * sizeof(size_t));
@@ -1623,8 +1954,10 @@ Search::optimize ()
                 if ((keys[i] = strndup(k, len)) == NULL)
                   errx(1, "strndup failed");
 #else
-                if ((keys[i] = strdup(k)) == NULL)
-                  errx(1, "strdup failed");
+                /* The keyword is not NUL terminated: it points into the input.  */
+                if ((keys[i] = (char*)malloc(len + 1)) == NULL)
+                  errx(1, "malloc failed");
+                memcpy(keys[i], k, len);
                 keys[i][len] = '\0';
 #endif
               }
@@ -1641,11 +1974,17 @@ Search::optimize ()
               if ((keys[i] = strndup(k, len)) == NULL)
                 errx(1, "strndup failed");
 #else
-              if ((keys[i] = strdup(k)) == NULL)
-                errx(1, "strdup failed");
+              /* The keyword is not NUL terminated: it points into the input.  */
+              if ((keys[i] = (char*)malloc(len + 1)) == NULL)
+                errx(1, "malloc failed");
+              memcpy(keys[i], k, len);
               keys[i][len] = '\0';
 #endif
             }
+          if (fold_case)
+            for (size_t j = 0; j < len; j++)
+              if (keys[i][j] >= 'A' && keys[i][j] <= 'Z')
+                keys[i][j] += 'a' - 'A';
           keylens[i] = len;
         }
       nbperf->n = _total_keys;
@@ -24,11 +24,13 @@
 #ifndef search_h
 #define search_h 1
 
+#include <time.h>
 #include "keyword-list.h"
 #include "positions.h"
 #include "bool-array.h"
 
 struct EquivalenceClass;
+class Hash_Table;
 
 class Search
 {
@@ -55,6 +57,10 @@ private:
   /* Count the duplicate keywords that occur with a given set of positions.  */
   unsigned int          count_duplicates_tuple (const Positions& positions, const unsigned int *alpha_unify) const;
 
+  /* Finds the positions that must occur in order to distinguish
+     duplicates.  */
+  void                  find_mandatory_positions (Positions& mandatory) const;
+
   /* Find good key positions.  */
   void                  find_positions ();
 
@@ -72,7 +78,7 @@ private:
 
   /* Count the duplicate keywords that occur with the given set of positions
      and a given alpha_inc[] array.  */
-  unsigned int          count_duplicates_multiset (const unsigned int *alpha_inc) const;
+  unsigned int          count_duplicates_multiset (const unsigned int *alpha_inc, Hash_Table& representatives) const;
 
   /* Find good _alpha_inc[].  */
   void                  find_alpha_inc ();
@@ -96,6 +102,10 @@ private:
   /* Finds good _asso_values[].  */
   void                  find_good_asso_values ();
 
+  /* Returns the processor time, in seconds, spent since the search
+     started.  */
+  float                 search_time () const;
+
   /* Sorts the keyword list by hash value.  */
   void                  sort ();
 
@@ -161,6 +171,9 @@ private:
 
   /* Sparse bit vector for collision detection.  */
   Bool_Array *          _collision_detector;
+
+  /* Processor time at the start of optimize().  */
+  clock_t               _start_time;
 };
 
 #endif
@@ -3,11 +3,12 @@
 #include <stdint.h>
 /* Need to include wyhash.h externally */
 
-/* MPH needs at least 96 bit */
-static inline void wyhash3(const void *key, size_t len, uint64_t seed, uint64_t *hashes){
+/* MPH needs at least 96 bit: the low and high half of the first hash
+   and the low half of the second.  */
+static inline void wyhash3(const void *key, size_t len, uint64_t seed, uint32_t *hashes){
   const uint64_t secret[4] = { _wyp[0],_wyp[1],_wyp[2],_wyp[3] };
   const uint8_t *p=(const uint8_t *)key; seed^=secret[0];
-  uint64_t a, b;
+  uint64_t a, b, h;
   if(_likely_(len<=16)){
     if(_likely_(len>=4)){
 	a=(_wyr4(p)<<32)|_wyr4(p+((len>>3)<<2));
@@ -17,7 +18,7 @@ static inline void wyhash3(const void *key, size_t len, uint64_t seed, uint64_t
     else a=b=0;
   }
   else{
-    size_t i=len; 
+    size_t i=len;
     if(_unlikely_(i>48)){
       uint64_t see1=seed, see2=seed;
       do{
@@ -31,6 +32,53 @@ static inline void wyhash3(const void *key, size_t len, uint64_t seed, uint64_t
     while(_unlikely_(i>16)){  seed=_wymix(_wyr8(p)^secret[1],_wyr8(p+8)^seed);  i-=16; p+=16;  }
     a=_wyr8(p+i-16);  b=_wyr8(p+i-8);
   }
-  hashes[0] = _wymix(secret[1]^len,_wymix(a^secret[1],b^seed));
-  hashes[1] = _wymix(b^secret[1],a^seed);
+  h = _wymix(secret[1]^len,_wymix(a^secret[1],b^seed));
+  hashes[0] = (uint32_t)h;
+  hashes[1] = (uint32_t)(h>>32);
+  hashes[2] = (uint32_t)_wymix(b^secret[1],a^seed);
+}
+
+/* Folds the ASCII upper case letters among the 8 bytes of x to lower case:
+   the bytes of h = x&0x7f.. from 'A' to 'Z' differ in their high bit after
+   adding 0x80-'A' and 0x80-'Z'-1, bytes with the high bit set in x are
+   left alone, and 0x80>>2 is 'a'-'A'.  */
+static inline uint64_t _wylower(uint64_t x){
+  const uint64_t ones=UINT64_C(0x0101010101010101);
+  uint64_t h=x&(0x7f*ones);
+  return x|((((h+(0x80-'A')*ones)^(h+(0x80-'Z'-1)*ones))&~x&(0x80*ones))>>2);
+}
+
+/* wyhash3 of the key with the ASCII upper case letters folded to lower
+   case, for --ignore-case: every word read is folded.  */
+static inline void wyhash3_lower(const void *key, size_t len, uint64_t seed, uint32_t *hashes){
+  const uint64_t secret[4] = { _wyp[0],_wyp[1],_wyp[2],_wyp[3] };
+  const uint8_t *p=(const uint8_t *)key; seed^=secret[0];
+  uint64_t a, b, h;
+  if(_likely_(len<=16)){
+    if(_likely_(len>=4)){
+	a=_wylower((_wyr4(p)<<32)|_wyr4(p+((len>>3)<<2)));
+	b=_wylower((_wyr4(p+len-4)<<32)|_wyr4(p+len-4-((len>>3)<<2)));
+    }
+    else if(_likely_(len>0)){ a=_wylower(_wyr3(p,len)); b=0;}
+    else a=b=0;
+  }
+  else{
+    size_t i=len;
+    if(_unlikely_(i>48)){
+      uint64_t see1=seed, see2=seed;
+      do{
+        seed=_wymix(_wylower(_wyr8(p))^secret[1],_wylower(_wyr8(p+8))^seed);
+        see1=_wymix(_wylower(_wyr8(p+16))^secret[2],_wylower(_wyr8(p+24))^see1);
+        see2=_wymix(_wylower(_wyr8(p+32))^secret[3],_wylower(_wyr8(p+40))^see2);
+        p+=48; i-=48;
+      }while(_likely_(i>48));
+      seed^=see1^see2;
+    }
+    while(_unlikely_(i>16)){  seed=_wymix(_wylower(_wyr8(p))^secret[1],_wylower(_wyr8(p+8))^seed);  i-=16; p+=16;  }
+    a=_wylower(_wyr8(p+i-16));  b=_wylower(_wyr8(p+i-8));
+  }
+  h = _wymix(secret[1]^len,_wymix(a^secret[1],b^seed));
+  hashes[0] = (uint32_t)h;
+  hashes[1] = (uint32_t)(h>>32);
+  hashes[2] = (uint32_t)_wymix(b^secret[1],a^seed);
 }
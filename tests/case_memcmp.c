@@ -0,0 +1,91 @@
+/*
+   Tests the gperf_case_memcmp function generated with --ignore-case, which
+   compares a word at a time, against a comparison a byte at a time.  All
+   pairs of bytes are compared at some positions of strings that are equal
+   up to case otherwise, at two alignments.  HEADER is the code generated
+   for c.gperf with --ignore-case and -l.  With SEVEN_BIT, the code was
+   generated with -7, and only the bytes < 0x80 are compared.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include HEADER
+
+#ifdef SEVEN_BIT
+#define MAX_BYTE 0x80
+#else
+#define MAX_BYTE 0x100
+#endif
+
+static int
+reference_case_memcmp (const char *s1, const char *s2, size_t n)
+{
+  for (; n > 0; n--)
+    {
+      unsigned char c1 = *s1++;
+      unsigned char c2 = *s2++;
+      if (c1 >= 'A' && c1 <= 'Z')
+        c1 += 'a' - 'A';
+      if (c2 >= 'A' && c2 <= 'Z')
+        c2 += 'a' - 'A';
+      if (c1 != c2)
+        return (int)c1 - (int)c2;
+    }
+  return 0;
+}
+
+int
+main ()
+{
+  /* The characters around 'A'..'Z' and 'a'..'z' are '@', '[', '`', '{'.  */
+  static const char filler[] = "Content-Type@[`{zZaA09Accept-Language";
+  static const size_t lengths[] = { 1, 7, 8, 9, 16, 17, 31 };
+  char buf1[64], buf2[64];
+  int errors = 0;
+  size_t l, pos, offset, i;
+  unsigned int c1, c2;
+
+  for (l = 0; l < sizeof (lengths) / sizeof (lengths[0]); l++)
+    {
+      size_t len = lengths[l];
+      for (offset = 0; offset < 4; offset += 3)
+        {
+          char *s1 = buf1 + offset;
+          char *s2 = buf2 + 1;
+          /* The same string, in the other case.  */
+          memcpy (s1, filler, len);
+          for (i = 0; i < len; i++)
+            {
+              unsigned char c = filler[i];
+              if (c >= 'A' && c <= 'Z')
+                c += 'a' - 'A';
+              else if (c >= 'a' && c <= 'z')
+                c -= 'a' - 'A';
+              s2[i] = c;
+            }
+          for (pos = 0; pos < len; pos += (len + 2) / 3)
+            {
+              char saved1 = s1[pos];
+              char saved2 = s2[pos];
+              for (c1 = 0; c1 < MAX_BYTE; c1++)
+                for (c2 = 0; c2 < MAX_BYTE; c2++)
+                  {
+                    int expected, result;
+                    s1[pos] = (char) c1;
+                    s2[pos] = (char) c2;
+                    expected = reference_case_memcmp (s1, s2, len);
+                    result = gperf_case_memcmp (s1, s2, len);
+                    if (result != expected && errors++ < 10)
+                      fprintf (stderr,
+                               "length %lu, position %lu: bytes %#x, %#x"
+                               " compare %d, expected %d\n",
+                               (unsigned long) len, (unsigned long) pos,
+                               c1, c2, result, expected);
+                  }
+              s1[pos] = saved1;
+              s2[pos] = saved2;
+            }
+        }
+    }
+  return errors > 0;
+}
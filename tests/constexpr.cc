@@ -0,0 +1,62 @@
+/*
+   Tests the C++ code generated with --constexpr.
+   HEADER is the generated code, for c.gperf.  The lookups of constant
+   strings are checked at compile time, the words read from the file given
+   as argument at run time.  With CLASS_TEMPLATE, the code was generated
+   with --class-template, and find is checked as well.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include HEADER
+
+#ifdef CLASS_TEMPLATE
+typedef Perfect_Hash<> PH;
+#else
+typedef Perfect_Hash PH;
+#endif
+
+static_assert (PH::in_word_set ("while") != nullptr,
+               "\"while\" is a keyword");
+static_assert (PH::in_word_set ("whilst") == nullptr,
+               "\"whilst\" is not a keyword");
+static_assert (PH::in_word_set ("") == nullptr,
+               "\"\" is not a keyword");
+
+#define MAX_LEN 80
+
+int
+main (int argc, char *argv[])
+{
+  char buf[MAX_LEN];
+  FILE *f = argc > 1 ? fopen (argv[1], "r") : stdin;
+  int ret = 0;
+
+  if (!f)
+    return 1;
+  while (fgets (buf, MAX_LEN, f))
+    {
+      size_t len = strlen (buf);
+      if (len > 0 && buf[len - 1] == '\n')
+        buf[--len] = '\0';
+
+      if (!PH::in_word_set (std::string_view (buf, len)))
+        {
+          printf ("NOT in word set %s\n", buf);
+          ret = 1;
+        }
+#ifdef CLASS_TEMPLATE
+      std::size_t index = PH::find (std::string_view (buf, len));
+      if (index == PH::npos
+          || PH::wordlist[index] != std::string_view (buf, len))
+        {
+          printf ("NOT in word set %s\n", buf);
+          ret = 1;
+        }
+#endif
+    }
+  if (argc > 1)
+    fclose (f);
+
+  return ret;
+}
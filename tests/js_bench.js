@@ -0,0 +1,155 @@
+/* Compares lookups in a keyword table generated with -L JavaScript -G,
+   with the tables built once when the module is loaded, as gperf generates
+   them, with the tables rebuilt by every call, as the older generated code
+   did, and with a JavaScript Set of the keywords.  The variant that
+   rebuilds the tables needs the asso_values table, which the MPH
+   algorithms don't have.
+   Usage: node js_bench.js GENERATED.js KEYWORDS [SECONDS]
+   KEYWORDS is a gperf input file; the keywords are looked up together
+   with as many non-keywords.  The module must use the default names
+   hash, in_word_set and wordlist.
+   The results are calls per second.  */
+
+"use strict";
+
+var fs = require ("fs");
+
+if (process.argv.length < 4)
+  {
+    console.error ("Usage: node js_bench.js GENERATED.js KEYWORDS [SECONDS]");
+    process.exit (1);
+  }
+var source = fs.readFileSync (process.argv[2], "utf8");
+var input = fs.readFileSync (process.argv[3], "utf8");
+var seconds = process.argv.length > 4 ? Number (process.argv[4]) : 1;
+
+/* Load the generated module.  */
+var name = /^var (\w+) = \(function/m.exec (source)[1];
+var mod = new Function (source + "\nreturn " + name + ";\n") ();
+if (mod.wordlist === undefined)
+  {
+    console.error (process.argv[2] + ": not generated with -G");
+    process.exit (1);
+  }
+
+/* Read the keywords: the lines of the keywords section, up to a comma.
+   As in gperf, with a single "%%" line the keywords come before it.  */
+var lines = input.split ("\n");
+var first = lines.indexOf ("%%");
+if (first >= 0)
+  {
+    var second = lines.indexOf ("%%", first + 1);
+    if (second >= 0)
+      lines = lines.slice (first + 1, second);
+    else
+      lines = lines.slice (0, first);
+  }
+var keywords = [];
+lines.forEach (function (line)
+  {
+    if (line.length > 0 && line[0] != "#")
+      keywords.push (line.split (",")[0]);
+  });
+
+/* Rebuild the functions with the tables inside their bodies.  */
+function body (f)
+{
+  var text = f.toString ();
+  return text.slice (text.indexOf ("{") + 1, text.lastIndexOf ("}"));
+}
+
+var in_word_set_per_call = null;
+if (mod.asso_values !== undefined)
+  {
+    var hash_per_call =
+      new Function ("str",
+                    "var asso_values = ["
+                    + Array.prototype.join.call (mod.asso_values, ", ") + "];\n"
+                    + body (mod.hash));
+    in_word_set_per_call =
+      new Function ("hash",
+                    "return function (str) {\n"
+                    + "var TOTAL_KEYWORDS = " + mod.TOTAL_KEYWORDS + ",\n"
+                    + "    MIN_WORD_LENGTH = " + mod.MIN_WORD_LENGTH + ",\n"
+                    + "    MAX_WORD_LENGTH = " + mod.MAX_WORD_LENGTH + ",\n"
+                    + "    MIN_HASH_VALUE = " + mod.MIN_HASH_VALUE + ",\n"
+                    + "    MAX_HASH_VALUE = " + mod.MAX_HASH_VALUE + ";\n"
+                    + "var wordlist = " + JSON.stringify (mod.wordlist) + ";\n"
+                    + body (mod.in_word_set) + "};\n") (hash_per_call);
+  }
+
+/* The Set of the keywords.  */
+var set = new Set (keywords);
+function in_set (str)
+{
+  return set.has (str);
+}
+
+/* The non-keywords differ from a keyword in the last character.  */
+var words = [];
+keywords.forEach (function (word)
+  {
+    words.push (word);
+    words.push (word.slice (0, -1)
+                + String.fromCharCode (word.charCodeAt (word.length - 1) ^ 1));
+  });
+
+/* Check the results.  */
+var errors = 0;
+words.forEach (function (word)
+  {
+    var expected = set.has (word);
+    if (mod.in_word_set (word) !== expected
+        || (in_word_set_per_call !== null
+            && in_word_set_per_call (word) !== expected))
+      {
+        console.error ("wrong result for \"" + word + "\"");
+        errors++;
+      }
+  });
+if (errors > 0)
+  process.exit (1);
+
+/* Returns a function that measures the calls per second of LOOKUP.  Each
+   variant gets its own copy of the loop, so that the call in the loop stays
+   monomorphic.  */
+function measurer (lookup)
+{
+  return new Function ("lookup", "words", "seconds",
+                       "var calls = 0;\n"
+                       + "var found = 0;\n"
+                       + "var start = process.hrtime.bigint ();\n"
+                       + "var end = start + BigInt (Math.round (seconds * 1e9));\n"
+                       + "var now;\n"
+                       + "do {\n"
+                       + "  for (var i = 0; i < words.length; i++)\n"
+                       + "    if (lookup (words[i]))\n"
+                       + "      found++;\n"
+                       + "  calls += words.length;\n"
+                       + "  now = process.hrtime.bigint ();\n"
+                       + "} while (now < end);\n"
+                       + "if (found == 0)\n"
+                       + "  throw new Error (\"no keyword found\");\n"
+                       + "return calls / (Number (now - start) / 1e9);\n")
+    .bind (null, lookup, words, seconds);
+}
+
+var measure_per_call =
+  in_word_set_per_call !== null ? measurer (in_word_set_per_call) : null;
+var measure_once = measurer (mod.in_word_set);
+var measure_set = measurer (in_set);
+
+/* Warm up the variants before measuring.  */
+if (measure_per_call !== null)
+  measure_per_call ();
+measure_once ();
+measure_set ();
+
+console.log ("keywords: " + keywords.length);
+if (measure_per_call !== null)
+  console.log ("tables built per call: "
+               + Math.round (measure_per_call ()) + " calls/s");
+console.log ("tables built once:     "
+             + Math.round (measure_once ()) + " calls/s");
+console.log ("JavaScript Set:        "
+             + Math.round (measure_set ()) + " calls/s");
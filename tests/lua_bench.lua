@@ -0,0 +1,147 @@
+-- Compares lookups in a keyword table generated with -L Lua -G, with the
+-- tables created once as upvalues, as gperf generates them, with the tables
+-- created by every call, as the older generated code did, and with a plain
+-- Lua table of the keywords.  The variant that creates the tables per call
+-- needs the asso_values table, which the MPH algorithms don't have.
+-- Usage: lua lua_bench.lua GENERATED.lua KEYWORDS [SECONDS]
+-- KEYWORDS is a gperf input file; the keywords are looked up together with
+-- as many non-keywords.  The module must use the default names hash,
+-- in_word_set and wordlist.
+-- The results are calls per second, measured in CPU time.  Needs Lua 5.3
+-- or newer.
+
+if #arg < 2 then
+    io.stderr:write("Usage: lua lua_bench.lua GENERATED.lua KEYWORDS [SECONDS]\n")
+    os.exit(1)
+end
+local seconds = tonumber(arg[3] or "1")
+
+local mod = dofile(arg[1])
+if mod.wordlist == nil then
+    io.stderr:write(arg[1] .. ": not generated with -G\n")
+    os.exit(1)
+end
+
+-- Read the keywords: the lines of the keywords section, up to a comma.
+-- As in gperf, with a single "%%" line the keywords come before it.
+local lines = {}
+for line in io.lines(arg[2]) do
+    lines[#lines + 1] = line
+end
+local first, second
+for i, line in ipairs(lines) do
+    if line == "%%" then
+        if first == nil then
+            first = i
+        elseif second == nil then
+            second = i
+        end
+    end
+end
+local from, to = 1, #lines
+if second ~= nil then
+    from, to = first + 1, second - 1
+elseif first ~= nil then
+    to = first - 1
+end
+local keywords = {}
+for i = from, to do
+    local line = lines[i]
+    if #line > 0 and line:sub(1, 1) ~= "#" then
+        keywords[#keywords + 1] = line:match("^[^,]*")
+    end
+end
+
+-- The plain table of the keywords.
+local set = {}
+for _, word in ipairs(keywords) do
+    set[word] = true
+end
+local function in_set(str)
+    return set[str] == true
+end
+
+-- The lookup function with the tables inside its body.
+local function literal(t, n)
+    local items = {}
+    for i = 1, n do
+        local v = t[i]
+        if type(v) == "string" then
+            items[i] = string.format("%q", v)
+        else
+            items[i] = tostring(v)
+        end
+    end
+    return "{" .. table.concat(items, ", ") .. "}"
+end
+local in_word_set_per_call = nil
+if mod.asso_values ~= nil then
+    local wordlist_size = mod.MAX_HASH_VALUE + 1
+    local source =
+        "local hash = ...\n" ..
+        "return function(str)\n" ..
+        "    local asso_values = " ..
+        literal(mod.asso_values, #mod.asso_values) .. "\n" ..
+        "    local wordlist = " .. literal(mod.wordlist, wordlist_size) .. "\n" ..
+        "    if #str <= " .. mod.MAX_WORD_LENGTH ..
+        " and #str >= " .. mod.MIN_WORD_LENGTH .. " then\n" ..
+        "        local key = hash(str)\n" ..
+        "        if key <= " .. mod.MAX_HASH_VALUE .. " and key >= 0 then\n" ..
+        "            return str == wordlist[key + 1]\n" ..
+        "        end\n" ..
+        "    end\n" ..
+        "    return false\n" ..
+        "end\n"
+    in_word_set_per_call = assert(load(source))(mod.hash)
+end
+
+-- The non-keywords differ from a keyword in the last character.
+local words = {}
+for _, word in ipairs(keywords) do
+    words[#words + 1] = word
+    words[#words + 1] = word:sub(1, -2) ..
+        string.char(word:byte(-1) ~ 1)
+end
+
+-- Check the results.
+local errors = 0
+for _, word in ipairs(words) do
+    local expected = set[word] == true
+    if mod.in_word_set(word) ~= expected
+       or (in_word_set_per_call ~= nil
+           and in_word_set_per_call(word) ~= expected) then
+        io.stderr:write("wrong result for \"" .. word .. "\"\n")
+        errors = errors + 1
+    end
+end
+if errors > 0 then
+    os.exit(1)
+end
+
+local function measure(lookup)
+    local calls = 0
+    local found = 0
+    local start = os.clock()
+    local now
+    repeat
+        for i = 1, #words do
+            if lookup(words[i]) then
+                found = found + 1
+            end
+        end
+        calls = calls + #words
+        now = os.clock()
+    until now - start >= seconds
+    assert(found > 0)
+    return calls / (now - start)
+end
+
+print(string.format("keywords: %d", #keywords))
+if in_word_set_per_call ~= nil then
+    print(string.format("tables created per call: %.0f calls/s",
+                        measure(in_word_set_per_call)))
+end
+print(string.format("tables as upvalues:      %.0f calls/s",
+                    measure(mod.in_word_set)))
+print(string.format("plain Lua table:         %.0f calls/s",
+                    measure(in_set)))
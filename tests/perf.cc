@@ -105,10 +105,11 @@ static inline void create_set (const size_t size) {
    printf("%s", cmd);
    return system(cmd);
  }
-static inline int run_result (const char *log, const uint32_t size) {
+static inline int run_result (const char *log, const char *miss_log,
+                              const uint32_t size) {
    char cmd[128];
-   snprintf(cmd, sizeof cmd, "./%s %s %s %u", perf_exe, perf_in,
-            log, size);
+   snprintf(cmd, sizeof cmd, "./%s %s %s %u %s", perf_exe, perf_in,
+            log, size, miss_log);
    return system(cmd);
  }
 
@@ -126,6 +127,9 @@ int main (int argc, char **argv)
      "--chm --mph-hash-function fnv",
      "--chm3 --mph-hash-function fnv3",
      "--bpz --mph-hash-function fnv3",
+     "--bpz --aligned-tables",
+     "--chm --packed-tables", "--chm3 --packed-tables",
+     "--fingerprints=8", "-l --fingerprints=16",
    };
    const uint32_t sizes[] = {
      20, 40, 80,
@@ -136,6 +140,7 @@ int main (int argc, char **argv)
    };
    FILE *comp = fopen("gperf.log", "w");
    FILE *run = fopen("run.log", "w");
+   FILE *miss = fopen("miss.log", "w");
    FILE *fsize = fopen("size.log", "w");
    srand(0xbeef);
 
@@ -153,8 +158,10 @@ int main (int argc, char **argv)
      printf("--- %s ---\n", option.c_str());
      fprintf(comp, "option: %s\n", option.c_str());
      fprintf(run, "option: %s\n", option.c_str());
+     fprintf(miss, "option: %s\n", option.c_str());
      fclose(comp);
      fclose(run);
+     fclose(miss);
      fprintf(fsize, "option: %s\n", option.c_str());
 
      for(int i=0; i<(sizeof sizes)/(sizeof *sizes); i++)
@@ -190,11 +197,12 @@ int main (int argc, char **argv)
            fprintf(fsize, "%20zu %20lu\n", size, st.st_size);
 
 #ifndef DUMMY
-           run_result ("run.log", size);
+           run_result ("run.log", "miss.log", size);
 #endif
          }
        }
      run = fopen("run.log", "a");
+     miss = fopen("miss.log", "a");
      comp = fopen("gperf.log", "a");
    }
 #if 1
@@ -207,5 +215,6 @@ int main (int argc, char **argv)
 #endif
    fclose(comp);
    fclose(run);
+   fclose(miss);
    fclose(fsize);
  }
@@ -3,7 +3,7 @@
 basedir="$(dirname $0)"
 VERSION=`${basedir}/../src/gperf --version | head -n1`
 if test -z "$PNG"; then
-  PNG="size gperf run"
+  PNG="size gperf run miss"
 fi
 
 perf_graph()
@@ -31,6 +31,12 @@ run() {
     "run-times ($VERSION)"
 }
 
+miss() {
+  perf_graph \
+    'miss.log' \
+    "run-times for non-keywords ($VERSION)"
+}
+
 for png in $PNG; do
     $png
     test -d ../doc && mv $png.png $png.svg ../doc/
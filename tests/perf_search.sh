@@ -0,0 +1,44 @@
+#!/bin/sh
+# Compares the total search time of the classic gperf algorithm with the
+# two collision detector representations of src/bool-array.h.
+# Usage: perf_search.sh [sizes...]
+# The times are the cycle counts which gperf_perf appends to gperf.log.
+basedir="$(dirname $0)"
+SRC=${basedir}/../src
+SIZES=${@:-"1000 2000 4000 8000"}
+if test -z "$GPERF_OPTIONS"; then
+  GPERF_OPTIONS="-I"
+fi
+
+create_set()
+{
+  awk -v n=$1 'BEGIN {
+      srand(n);
+      alpha = "abcdefghijklmnopqrstuvwxyz0123456789_ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+      for (i = 0; i < n; i++) {
+        len = 2 + int(rand() * 12);
+        w = "";
+        for (j = 0; j < len; j++)
+          w = w substr(alpha, 1 + int(rand() * length(alpha)), 1);
+        print w;
+      }
+    }' | sort | uniq > _perf_search$1.gperf
+}
+
+run_gperf()
+{
+  rm -f gperf.log
+  $1 $GPERF_OPTIONS _perf_search$2.gperf > /dev/null || exit 1
+  awk '{ print $2 }' < gperf.log
+}
+
+printf "%10s %20s %20s %20s\n" size auto array compact
+for size in $SIZES; do
+  create_set $size
+  auto=`run_gperf $SRC/gperf_perf $size`
+  array=`run_gperf $SRC/gperf_perf_array $size`
+  compact=`run_gperf $SRC/gperf_perf_compact $size`
+  printf "%10s %20s %20s %20s\n" $size $auto $array $compact
+  rm -f _perf_search$size.gperf
+done
+rm -f gperf.log
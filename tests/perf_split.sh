@@ -0,0 +1,52 @@
+#!/bin/sh
+# Compares lookups in a struct keyword table with large payloads, with the
+# default array of structs and with option --split-table.
+# Usage: perf_split.sh [sizes...]
+# PAYLOAD sets the payload size of each struct, in bytes.
+# The times are cycles per lookup, for hits and for misses.
+basedir="$(dirname $0)"
+GPERF=${basedir}/../src/gperf
+SIZES=${@:-"1000 4000"}
+if test -z "$PAYLOAD"; then
+  PAYLOAD=256
+fi
+if test -z "$GPERF_OPTIONS"; then
+  GPERF_OPTIONS="-I"
+fi
+if test -z "$CC"; then
+  CC=cc
+fi
+
+create_set()
+{
+  awk -v n=$1 'BEGIN {
+      srand(n);
+      alpha = "abcdefghijklmnopqrstuvwxyz0123456789_ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+      for (i = 0; i < n; i++) {
+        len = 2 + int(rand() * 12);
+        w = "";
+        for (j = 0; j < len; j++)
+          w = w substr(alpha, 1 + int(rand() * length(alpha)), 1);
+        print w;
+      }
+    }' | sort | uniq > _perf_split$1.txt
+  { printf 'struct keyword { const char *name; char payload[%d]; };\n%%%%\n' $PAYLOAD
+    cat _perf_split$1.txt
+  } > _perf_split$1.gperf
+}
+
+run_lookups()
+{
+  $GPERF -t $GPERF_OPTIONS $2 _perf_split$1.gperf > _perf_split$1.c || exit 1
+  $CC -O2 -I${basedir} _perf_split$1.c ${basedir}/perf_split_test.c \
+    -o _perf_split$1 || exit 1
+  ./_perf_split$1 _perf_split$1.txt || exit 1
+}
+
+printf "%10s %12s %12s %12s %12s\n" size hit hit-split miss miss-split
+for size in $SIZES; do
+  create_set $size
+  set -- `run_lookups $size ""` `run_lookups $size --split-table`
+  printf "%10s %12s %12s %12s %12s\n" $size $1 $3 $2 $4
+  rm -f _perf_split$size.txt _perf_split$size.gperf _perf_split$size.c _perf_split$size
+done
@@ -0,0 +1,79 @@
+/*
+   Measure lookups in a keyword table of large structs, for hits and for
+   misses which reach the key comparison.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "perf.h"
+
+struct keyword;
+extern const struct keyword * in_word_set (const char *, size_t);
+
+#define MAX_LEN 80
+
+static char (*words)[MAX_LEN];
+static size_t *lens;
+static unsigned int count;
+
+/* Returns the average number of cycles per lookup.  */
+static uint64_t
+measure (unsigned int *found)
+{
+  unsigned int i, loop;
+  uint64_t t = timer_start ();
+  for (loop = 0; loop < PERF_LOOP; loop++)
+    for (i = 0; i < count; i++)
+      if (in_word_set (words[i], lens[i]))
+        (*found)++;
+  t = timer_end () - t;
+  return t / ((uint64_t) PERF_LOOP * count);
+}
+
+int
+main (int argc, char *argv[])
+{
+  FILE *f = fopen (argv[1], "r");
+  char buf[MAX_LEN];
+  unsigned int i, found = 0;
+  uint64_t hit, miss;
+
+  if (!f)
+    return 1;
+  while (fgets (buf, MAX_LEN, f))
+    count++;
+  rewind (f);
+  words = malloc (count * sizeof (*words));
+  lens = malloc (count * sizeof (*lens));
+  for (i = 0; i < count && fgets (words[i], MAX_LEN, f); i++)
+    {
+      size_t len = strlen (words[i]);
+      if (len > 0 && words[i][len - 1] == '\n')
+        words[i][--len] = '\0';
+      lens[i] = len;
+    }
+  fclose (f);
+
+  hit = measure (&found);
+  if (found != PERF_LOOP * count)
+    {
+      printf ("NOT all keywords found\n");
+      return 1;
+    }
+
+  /* Same lengths and mostly the same hash values, but a different last
+     character, which is not in the keyword alphabet.  */
+  for (i = 0; i < count; i++)
+    words[i][lens[i] - 1] = '#';
+  found = 0;
+  miss = measure (&found);
+  if (found != 0)
+    {
+      printf ("non-keyword found\n");
+      return 1;
+    }
+
+  printf ("%lu %lu\n", (unsigned long) hit, (unsigned long) miss);
+  return 0;
+}
@@ -0,0 +1,49 @@
+#!/bin/sh
+# Compares the switch statements of -S with and without --switch-by-length,
+# the compare cascade of --cascade and the default lookup table, on the
+# keywords of the bundled grammars.
+# Usage: perf_switch.sh [grammars...]
+# The sizes are the bytes of machine code of the generated functions, the
+# times cycles per lookup, for hits and for misses.
+basedir="$(dirname $0)"
+GPERF=${basedir}/../src/gperf
+GRAMMARS=${@:-"ada c c-parse cplusplus gpc irc java languages modula3 objc pascal"}
+if test -z "$CC"; then
+  CC=cc
+fi
+
+# Writes the keywords of a grammar, one per line, without the struct
+# initializers and without the quoted keywords.
+extract_keywords()
+{
+  awk -v sections=`grep -c '^%%' $1` '
+    BEGIN { section = sections == 0 ? 1 : 0 }
+    /^%%/ { section++; next }
+    section == 1 && NF > 0 && !/^#/ && !/^"/ { sub(/,.*/, ""); print }' $1 \
+    | sort | uniq > _perf_switch.txt
+}
+
+# Prints the code size and the cycles per lookup for a hit and for a miss.
+run_lookups()
+{
+  $GPERF $1 _perf_switch.txt > _perf_switch.c || exit 1
+  $CC -O2 -c _perf_switch.c -o _perf_switch.o || exit 1
+  $CC -O2 -I${basedir} _perf_switch.o ${basedir}/perf_split_test.c \
+    -o _perf_switch || exit 1
+  echo `size _perf_switch.o | awk 'NR == 2 { print $1 }'` \
+       `./_perf_switch _perf_switch.txt` || exit 1
+}
+
+printf "%-10s %5s %17s %17s %17s %17s\n" "" "" "table" "-S 1" \
+  "--switch-by-length" "--cascade"
+printf "%-10s %5s %5s %5s %5s %5s %5s %5s %5s %5s %5s %5s %5s %5s\n" grammar \
+  words size hit miss size hit miss size hit miss size hit miss
+for grammar in $GRAMMARS; do
+  extract_keywords ${basedir}/$grammar.gperf
+  set -- `run_lookups "-I"` `run_lookups "-I -S 1"` \
+         `run_lookups "-I --switch-by-length"` `run_lookups "-I --cascade"`
+  printf "%-10s %5s %5s %5s %5s %5s %5s %5s %5s %5s %5s %5s %5s %5s\n" \
+    $grammar `wc -l < _perf_switch.txt` $1 $2 $3 $4 $5 $6 $7 $8 $9 \
+    ${10} ${11} ${12}
+done
+rm -f _perf_switch.txt _perf_switch.c _perf_switch.o _perf_switch
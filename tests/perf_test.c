@@ -1,5 +1,8 @@
 /*
    Measure the generated perfect hash functions.
+   Usage: perf_set words log size [miss-log]
+   With miss-log, also measure lookups of non-keywords: the words with
+   their last character replaced, which mostly reach the string compare.
 */
 
 #include <stdio.h>
@@ -49,6 +52,42 @@ main (int argc, char *argv[])
   f = fopen (log, "a");
   fprintf(f, "%20zu %20lu\n", size, t / PERF_LOOP);
   fclose(f);
-  
+
+  if (argc > 4)
+    {
+      f = fopen (in, "r");
+      i = 0;
+      t = timer_start ();
+    restart_miss:
+      while (fgets (buf, MAX_LEN, f))
+        {
+          size_t len = strlen (buf);
+          if (len > 0 && buf[len - 1] == '\n')
+            buf[--len] = '\0';
+          if (len == 0)
+            continue;
+          buf[len - 1] = '#';
+
+          if (in_word_set (buf, len))
+            {
+              ret = 1;
+              printf ("in word set %s\n", buf);
+            }
+          i++;
+          if (i > PERF_LOOP)
+            break;
+        }
+      if (i < PERF_LOOP)
+        {
+          rewind (f);
+          goto restart_miss;
+        }
+      t = timer_end () - t;
+      fclose(f);
+      f = fopen (argv[4], "a");
+      fprintf(f, "%20zu %20lu\n", size, t / PERF_LOOP);
+      fclose(f);
+    }
+
   return ret;
 }
@@ -7,6 +7,9 @@
 #include <string.h>
 
 extern const char * in_word_set (const char *, size_t);
+#ifdef BINARY_TABLES
+extern int in_word_set_load (const char *);
+#endif
 
 #define MAX_LEN 255
 
@@ -22,6 +25,10 @@ main (int argc, char *argv[])
 
   if (!in)
     return 1;
+#ifdef BINARY_TABLES
+  if (in_word_set_load (BINARY_TABLES) != 0)
+    return 1;
+#endif
   FILE *f = fopen (in, "r");
   while (fgets (buf, MAX_LEN, f))
     {